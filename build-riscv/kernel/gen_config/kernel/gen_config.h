@@ -41,6 +41,17 @@
 #define CONFIG_MAX_NUM_TRACE_POINTS 0
 #define CONFIG_IRQ_REPORTING 1
 #define CONFIG_COLOUR_PRINTING 1
+#define CONFIG_KERNEL_PRINT_BUFFER_BITS 12
+#define CONFIG_KERNEL_PRINT_FLUSH_CHUNK 64
+#define CONFIG_RISCV_CONSOLE_UART_PADDR 0x11200
+#define CONFIG_PROFILER_SAMPLE_BITS 9
+#define CONFIG_PROFILER_SAMPLE_INTERVAL 1
+#define CONFIG_CAP_LOOKUP_CACHE_BITS 4
+#define CONFIG_EP_BADGE_INDEX_BITS 8
+#define CONFIG_NTFN_USER_WORD_SLOTS 64
+#define CONFIG_WAIT_SET_SLOTS 64
+#define CONFIG_EP_PRIORITY_QUEUE_SLOTS 16
+#define CONFIG_RISCV_CBOM_BLOCK_BITS 6
 #define CONFIG_USER_STACK_TRACE_LENGTH 16
 #define CONFIG_KERNEL_OPT_LEVEL_O2 1
 #define CONFIG_KERNEL_OPT_LEVEL -O2
\ No newline at end of file
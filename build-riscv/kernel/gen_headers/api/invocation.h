@@ -62,6 +62,8 @@ enum invocation_label {
     IRQSetIRQHandler,
     IRQClearIRQHandler,
     DomainSetSet,
+    UntypedDescribe,
+    UntypedDescribeRange,
     nInvocationLabels
 };
 
@@ -25,6 +25,12 @@ enum arch_invocation_label {
     RISCVPageGetAddress,
     RISCVASIDControlMakePool,
     RISCVASIDPoolAssign,
+    RISCVPageTableMapFrames,
+    RISCVPageTableTeardown,
+    RISCVPageClean_Data,
+    RISCVPageInvalidate_Data,
+    RISCVPageCleanInvalidate_Data,
+    RISCVPageUnify_Instruction,
     nArchInvocationLabels
 };
 
@@ -27,11 +27,16 @@
 #define SYSCALL_REPLY (-6)
 #define SYSCALL_YIELD (-7)
 #define SYSCALL_NB_RECV (-8)
+#define SYSCALL_MULTICALL (-9)
+#define SYSCALL_IRQ_ACK_WAIT (-10)
+#define SYSCALL_NTFN_SET_USER_WORD (-11)
+#define SYSCALL_WAIT_SET_JOIN (-12)
+#define SYSCALL_WAIT_SET_RECV (-13)
 
 #endif
 
 #define SYSCALL_MAX (-1)
-#define SYSCALL_MIN (-8)
+#define SYSCALL_MIN (-13)
 
 #ifndef __ASSEMBLER__
 
@@ -44,37 +49,68 @@ enum syscall {
     SysReply = -6,
     SysYield = -7,
     SysNBRecv = -8,
+#if defined CONFIG_MULTICALL
+    SysMulticall = -9,
+#endif /* defined CONFIG_MULTICALL */
+#if defined CONFIG_IRQ_ACK_WAIT
+    SysIRQAckWait = -10,
+#endif /* defined CONFIG_IRQ_ACK_WAIT */
+#if defined CONFIG_NTFN_USER_WORD
+    SysNtfnSetUserWord = -11,
+#endif /* defined CONFIG_NTFN_USER_WORD */
+#if defined CONFIG_WAIT_SET
+    SysWaitSetJoin = -12,
+    SysWaitSetRecv = -13,
+#endif /* defined CONFIG_WAIT_SET */
 #if defined CONFIG_PRINTING
-    SysDebugPutChar = -9,
-    SysDebugDumpScheduler = -10,
+    SysDebugPutChar = -14,
+    SysDebugDumpScheduler = -15,
 #endif /* defined CONFIG_PRINTING */
 #if defined CONFIG_DEBUG_BUILD
-    SysDebugHalt = -11,
-    SysDebugCapIdentify = -12,
-    SysDebugSnapshot = -13,
-    SysDebugNameThread = -14,
+    SysDebugHalt = -16,
+    SysDebugCapIdentify = -17,
+    SysDebugSnapshot = -18,
+    SysDebugNameThread = -19,
 #endif /* defined CONFIG_DEBUG_BUILD */
 #if defined CONFIG_DANGEROUS_CODE_INJECTION
-    SysDebugRun = -15,
+    SysDebugRun = -20,
 #endif /* defined CONFIG_DANGEROUS_CODE_INJECTION */
 #if defined CONFIG_ENABLE_BENCHMARKS
-    SysBenchmarkFlushCaches = -16,
-    SysBenchmarkResetLog = -17,
-    SysBenchmarkFinalizeLog = -18,
-    SysBenchmarkSetLogBuffer = -19,
-    SysBenchmarkNullSyscall = -20,
+    SysBenchmarkFlushCaches = -21,
+    SysBenchmarkResetLog = -22,
+    SysBenchmarkFinalizeLog = -23,
+    SysBenchmarkSetLogBuffer = -24,
+    SysBenchmarkNullSyscall = -25,
 #endif /* defined CONFIG_ENABLE_BENCHMARKS */
 #if defined CONFIG_BENCHMARK_TRACK_UTILISATION
-    SysBenchmarkGetThreadUtilisation = -21,
-    SysBenchmarkResetThreadUtilisation = -22,
+    SysBenchmarkGetThreadUtilisation = -26,
+    SysBenchmarkResetThreadUtilisation = -27,
 #endif /* defined CONFIG_BENCHMARK_TRACK_UTILISATION */
 #if defined CONFIG_KERNEL_X86_DANGEROUS_MSR
-    SysX86DangerousWRMSR = -23,
-    SysX86DangerousRDMSR = -24,
+    SysX86DangerousWRMSR = -28,
+    SysX86DangerousRDMSR = -29,
 #endif /* defined CONFIG_KERNEL_X86_DANGEROUS_MSR */
 #if defined CONFIG_VTX
-    SysVMEnter = -25,
+    SysVMEnter = -30,
 #endif /* defined CONFIG_VTX */
+#if defined CONFIG_KERNEL_PRINT_BUFFER
+    SysDebugSetPrintBuffer = -31,
+#endif /* defined CONFIG_KERNEL_PRINT_BUFFER */
+#if defined CONFIG_IRQ_STATISTICS
+    SysDebugGetIRQStatistics = -32,
+    SysDebugResetIRQStatistics = -33,
+#endif /* defined CONFIG_IRQ_STATISTICS */
+#if defined CONFIG_PROFILER_SAMPLING
+    SysDebugSetProfilerNotification = -34,
+    SysDebugGetProfilerSamples = -35,
+#endif /* defined CONFIG_PROFILER_SAMPLING */
+#if defined CONFIG_BENCHMARK_LATENCY_HISTOGRAMS
+    SysBenchmarkGetLatencyHistogram = -36,
+    SysBenchmarkResetLatencyHistograms = -37,
+#endif /* defined CONFIG_BENCHMARK_LATENCY_HISTOGRAMS */
+#if defined CONFIG_CAP_LOOKUP_CACHE
+    SysBenchmarkGetCapLookupCacheStats = -38,
+#endif /* defined CONFIG_CAP_LOOKUP_CACHE */
 };
 typedef word_t syscall_t;
 
@@ -89,6 +125,11 @@ static char *syscall_names[] UNUSED = {
          [6] = "Reply",
          [7] = "Yield",
          [8] = "NBRecv",
+         [9] = "Multicall",
+         [10] = "IRQAckWait",
+         [11] = "NtfnSetUserWord",
+         [12] = "WaitSetJoin",
+         [13] = "WaitSetRecv",
 };
 #endif /* CONFIG_DEBUG_BUILD */
 #endif
@@ -0,0 +1,32 @@
+/*
+ * Copyright 2017, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+
+#ifndef __BENCHMARK_KERNEL_TRACEPOINTS_H
+#define __BENCHMARK_KERNEL_TRACEPOINTS_H
+
+#include <config.h>
+
+#if CONFIG_MAX_NUM_TRACE_POINTS > 0
+/* Tracepoint ids used by the kernel itself. The host side analyser
+ * (scripts/tracepoints.py) uses the same numbering to name log entries,
+ * so only ever append to this list. */
+enum tracepoint_id {
+    TRACE_POINT_DECODE_INVOCATION = 0,
+    TRACE_POINT_SCHEDULE = 1,
+    TRACE_POINT_SET_VM_ROOT = 2,
+    TRACE_POINT_RESET_UNTYPED = 3,
+    TRACE_POINT_CTE_REVOKE = 4,
+    TRACE_POINT_NUM
+};
+#endif /* CONFIG_MAX_NUM_TRACE_POINTS > 0 */
+
+#endif /* __BENCHMARK_KERNEL_TRACEPOINTS_H */
@@ -0,0 +1,33 @@
+/*
+ * Copyright 2017, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+
+#ifndef __BENCHMARK_RISCV_BENCHMARK_H
+#define __BENCHMARK_RISCV_BENCHMARK_H
+
+#include <config.h>
+#include <stdint.h>
+
+/* The last 1GiB of the kernel window is not used for the physical memory
+ * mapping. The kernel log buffer, when configured, is mapped at its base. */
+#define KS_LOG_PPTR 0xFFFFFFFFC0000000lu
+
+#ifdef CONFIG_ENABLE_BENCHMARKS
+static inline uint64_t
+timestamp(void)
+{
+    uint64_t cycles;
+    asm volatile("rdcycle %0" : "=r"(cycles));
+    return cycles;
+}
+#endif /* CONFIG_ENABLE_BENCHMARKS */
+
+#endif /* __BENCHMARK_RISCV_BENCHMARK_H */
@@ -259,7 +259,9 @@ setMRs_fault(tcb_t *sender, tcb_t* receiver, word_t *receiveIPCBuffer)
  */
 
 #include <types.h>
+#include <benchmark/riscv_benchmark.h>
 #include <benchmark/benchmark.h>
+#include <benchmark/kernel_tracepoints.h>
 #include <arch/benchmark.h>
 #include <benchmark/benchmark_track.h>
 #include <benchmark/benchmark_utilisation.h>
@@ -282,6 +284,51 @@ setMRs_fault(tcb_t *sender, tcb_t* receiver, word_t *receiveIPCBuffer)
 #include <arch/machine/capdl.h>
 #endif
 
+#if defined(CONFIG_PRINTING) && defined(CONFIG_KERNEL_PRINT_BUFFER)
+exception_t setPrintBuffer(word_t frame_cptr);
+#endif
+
+#ifdef CONFIG_IRQ_STATISTICS
+void irqStatsSpuriousIRQ(void);
+exception_t irqStatsDump(void);
+void irqStatsReset(void);
+#endif
+
+#ifdef CONFIG_BENCHMARK_USE_KERNEL_LOG_BUFFER
+exception_t benchmark_arch_map_logBuffer(word_t frame_cptr);
+#endif
+
+#ifdef CONFIG_PROFILER_SAMPLING
+extern bool_t profilerFromTrap;
+exception_t profilerSetNotification(word_t ntfn_cptr);
+word_t profilerDrain(void);
+#endif
+
+#ifdef CONFIG_BENCHMARK_LATENCY_HISTOGRAMS
+exception_t latencyHistDump(word_t table, word_t index);
+void latencyHistReset(void);
+#endif
+
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+exception_t capLookupCacheDump(bool_t reset);
+#endif
+
+#ifdef CONFIG_NTFN_USER_WORD
+exception_t ntfnSetUserWord(word_t ntfn_cptr, word_t frame_cptr, word_t offset);
+#endif
+
+#ifdef CONFIG_WAIT_SET
+/* msgInfo value of a SysWaitSetRecv answered by a plain notification */
+#define WAIT_SET_NO_MEMBER wordBits
+
+exception_t waitSetJoin(word_t set_cptr, word_t member_cptr, word_t bit);
+bool_t receiveWaitSet(tcb_t *thread, cap_t cap);
+#endif
+
+#if CONFIG_MAX_NUM_TRACE_POINTS > 0
+compile_assert(kernel_tracepoints_fit, TRACE_POINT_NUM <= CONFIG_MAX_NUM_TRACE_POINTS)
+#endif
+
 /* The haskell function 'handleEvent' is split into 'handleXXX' variants
  * for each event causing a kernel entry */
 
@@ -293,11 +340,20 @@ handleInterruptEntry(void)
     irq = getActiveIRQ();
 
     if (irq != irqInvalid) {
+#ifdef CONFIG_PROFILER_SAMPLING
+        profilerFromTrap = true;
+#endif
         handleInterrupt(irq);
+#ifdef CONFIG_PROFILER_SAMPLING
+        profilerFromTrap = false;
+#endif
         Arch_finaliseInterrupt();
     } else {
 #ifdef CONFIG_IRQ_REPORTING
         userError("Spurious interrupt!");
+#endif
+#ifdef CONFIG_IRQ_STATISTICS
+        irqStatsSpuriousIRQ();
 #endif
         handleSpuriousIRQ();
     }
@@ -322,7 +378,79 @@ handleUnknownSyscall(word_t w)
 #endif
         return EXCEPTION_NONE;
     }
-#endif
+#ifdef CONFIG_KERNEL_PRINT_BUFFER
+    if (w == SysDebugSetPrintBuffer) {
+        word_t cptr_userFrame = getRegister(NODE_STATE(ksCurThread), capRegister);
+
+        if (setPrintBuffer(cptr_userFrame) != EXCEPTION_NONE) {
+            setRegister(NODE_STATE(ksCurThread), capRegister, seL4_IllegalOperation);
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+
+        setRegister(NODE_STATE(ksCurThread), capRegister, seL4_NoError);
+        return EXCEPTION_NONE;
+    }
+#endif /* CONFIG_KERNEL_PRINT_BUFFER */
+#endif /* CONFIG_PRINTING */
+#ifdef CONFIG_IRQ_STATISTICS
+    if (w == SysDebugGetIRQStatistics) {
+        if (irqStatsDump() != EXCEPTION_NONE) {
+            setRegister(NODE_STATE(ksCurThread), capRegister, seL4_RangeError);
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+        setRegister(NODE_STATE(ksCurThread), capRegister, seL4_NoError);
+        return EXCEPTION_NONE;
+    }
+    if (w == SysDebugResetIRQStatistics) {
+        irqStatsReset();
+        return EXCEPTION_NONE;
+    }
+#endif /* CONFIG_IRQ_STATISTICS */
+#ifdef CONFIG_PROFILER_SAMPLING
+    if (w == SysDebugSetProfilerNotification) {
+        word_t cptr = getRegister(NODE_STATE(ksCurThread), capRegister);
+
+        if (profilerSetNotification(cptr) != EXCEPTION_NONE) {
+            setRegister(NODE_STATE(ksCurThread), capRegister, seL4_IllegalOperation);
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+        setRegister(NODE_STATE(ksCurThread), capRegister, seL4_NoError);
+        return EXCEPTION_NONE;
+    }
+    if (w == SysDebugGetProfilerSamples) {
+        setRegister(NODE_STATE(ksCurThread), capRegister, profilerDrain());
+        return EXCEPTION_NONE;
+    }
+#endif /* CONFIG_PROFILER_SAMPLING */
+#ifdef CONFIG_BENCHMARK_LATENCY_HISTOGRAMS
+    if (w == SysBenchmarkGetLatencyHistogram) {
+        word_t table = getRegister(NODE_STATE(ksCurThread), capRegister);
+        word_t index = getRegister(NODE_STATE(ksCurThread), msgInfoRegister);
+
+        if (latencyHistDump(table, index) != EXCEPTION_NONE) {
+            setRegister(NODE_STATE(ksCurThread), capRegister, seL4_RangeError);
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+        setRegister(NODE_STATE(ksCurThread), capRegister, seL4_NoError);
+        return EXCEPTION_NONE;
+    }
+    if (w == SysBenchmarkResetLatencyHistograms) {
+        latencyHistReset();
+        return EXCEPTION_NONE;
+    }
+#endif /* CONFIG_BENCHMARK_LATENCY_HISTOGRAMS */
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+    if (w == SysBenchmarkGetCapLookupCacheStats) {
+        bool_t reset = getRegister(NODE_STATE(ksCurThread), capRegister) != 0;
+
+        if (capLookupCacheDump(reset) != EXCEPTION_NONE) {
+            setRegister(NODE_STATE(ksCurThread), capRegister, seL4_IllegalOperation);
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+        setRegister(NODE_STATE(ksCurThread), capRegister, seL4_NoError);
+        return EXCEPTION_NONE;
+    }
+#endif /* CONFIG_CAP_LOOKUP_CACHE */
 #ifdef CONFIG_DEBUG_BUILD
     if (w == SysDebugHalt) {
         tcb_t * UNUSED tptr = NODE_STATE(ksCurThread);
@@ -538,6 +666,11 @@ handleInvocation(bool_t isCall, bool_t isBlocking)
         return EXCEPTION_NONE;
     }
 
+#if defined(CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES) || defined(CONFIG_BENCHMARK_LATENCY_HISTOGRAMS)
+    ksKernelEntry.cap_type = cap_get_capType(lu_ret.cap);
+    ksKernelEntry.invocation_tag = seL4_MessageInfo_get_label(info);
+#endif
+
     buffer = lookupIPCBuffer(false, thread);
 
     status = lookupExtraCaps(thread, buffer, info);
@@ -555,10 +688,12 @@ handleInvocation(bool_t isCall, bool_t isBlocking)
     if (unlikely(length > n_msgRegisters && !buffer)) {
         length = n_msgRegisters;
     }
+    TRACE_POINT_START(TRACE_POINT_DECODE_INVOCATION);
     status = decodeInvocation(seL4_MessageInfo_get_label(info), length,
                               cptr, lu_ret.slot, lu_ret.cap,
                               current_extra_caps, isBlocking, isCall,
                               buffer);
+    TRACE_POINT_STOP(TRACE_POINT_DECODE_INVOCATION);
 
     if (unlikely(status == EXCEPTION_PREEMPTED)) {
         return status;
@@ -582,6 +717,190 @@ handleInvocation(bool_t isCall, bool_t isBlocking)
     return EXCEPTION_NONE;
 }
 
+#ifdef CONFIG_MULTICALL
+/* A multicall batch is an array of variable length records in a RAM frame,
+ * laid out in words as:
+ *
+ *   [0] cptr of the invoked cap
+ *   [1] status, set to MULTICALL_PENDING by the caller and to the
+ *       seL4_Error of the invocation by the kernel
+ *   [2] seL4_MessageInfo_t of the invocation
+ *   [3] length message words, followed by extraCaps cptrs
+ *
+ * The records are decoded exactly as if each had been sent with seL4_Send
+ * from the IPC buffer, so nothing is returned beyond the status. Records
+ * that are no longer pending are skipped, which is what makes the batch
+ * restartable after preemption. */
+#define MULTICALL_REC_CPTR   0
+#define MULTICALL_REC_STATUS 1
+#define MULTICALL_REC_INFO   2
+#define MULTICALL_REC_ARGS   3
+#define MULTICALL_PENDING    ((word_t) -1)
+
+static exception_t
+multicallLookupExtraCaps(tcb_t *thread, word_t *caps, word_t count)
+{
+    lookupSlot_raw_ret_t lu_ret;
+    word_t i;
+
+    for (i = 0; i < count; i++) {
+        lu_ret = lookupSlot(thread, caps[i]);
+        if (unlikely(lu_ret.status != EXCEPTION_NONE)) {
+            return lu_ret.status;
+        }
+        current_extra_caps.excaprefs[i] = lu_ret.slot;
+    }
+    if (i < seL4_MsgMaxExtraCaps) {
+        current_extra_caps.excaprefs[i] = NULL;
+    }
+
+    return EXCEPTION_NONE;
+}
+
+static exception_t
+handleMulticall(void)
+{
+    tcb_t *thread;
+    cptr_t frame_cptr;
+    word_t count, done, offset, i;
+    word_t result;
+    exception_t status;
+
+    thread = NODE_STATE(ksCurThread);
+    frame_cptr = getRegister(thread, capRegister);
+    count = getRegister(thread, msgInfoRegister);
+    result = seL4_NoError;
+    offset = 0;
+
+    /* Stays in Restart until the whole batch has been walked so that a
+     * preempted batch is re-entered from the top, skipping finished records */
+    setThreadState(thread, ThreadState_Restart);
+
+    for (done = 0; done < count; done++) {
+        lookupCap_ret_t frame_ret;
+        lookupCapAndSlot_ret_t lu_ret;
+        seL4_MessageInfo_t info;
+        word_t *rec, frame_words, length, extra;
+        word_t tsType;
+
+        /* An earlier record may have deleted or revoked the batch frame. The
+         * kernel writes each record's status back, so as for an IPC buffer
+         * the cap must allow writes. */
+        frame_ret = lookupCap(thread, frame_cptr);
+        if (unlikely(frame_ret.status != EXCEPTION_NONE ||
+                     cap_get_capType(frame_ret.cap) != cap_frame_cap ||
+                     cap_frame_cap_get_capFIsDevice(frame_ret.cap) ||
+                     cap_frame_cap_get_capFVMRights(frame_ret.cap) != VMReadWrite)) {
+            userError("Multicall: batch must be a writable RAM frame cap.");
+            result = seL4_IllegalOperation;
+            break;
+        }
+        rec = (word_t *) cap_frame_cap_get_capFBasePtr(frame_ret.cap) + offset;
+        frame_words = BIT(pageBitsForSize(cap_frame_cap_get_capFSize(frame_ret.cap))) / sizeof(word_t);
+
+        if (unlikely(offset + MULTICALL_REC_ARGS > frame_words)) {
+            userError("Multicall: record %lu runs off the end of the batch.", done);
+            result = seL4_RangeError;
+            break;
+        }
+        info = messageInfoFromWord(rec[MULTICALL_REC_INFO]);
+        length = seL4_MessageInfo_get_length(info);
+        extra = seL4_MessageInfo_get_extraCaps(info);
+        if (unlikely(offset + MULTICALL_REC_ARGS + length + extra > frame_words)) {
+            userError("Multicall: record %lu runs off the end of the batch.", done);
+            result = seL4_RangeError;
+            break;
+        }
+        offset += MULTICALL_REC_ARGS + length + extra;
+
+        if (rec[MULTICALL_REC_STATUS] != MULTICALL_PENDING) {
+            continue;
+        }
+
+        lu_ret = lookupCapAndSlot(thread, rec[MULTICALL_REC_CPTR]);
+        if (unlikely(lu_ret.status != EXCEPTION_NONE)) {
+            userError("Multicall: invocation of invalid cap #%lu.", rec[MULTICALL_REC_CPTR]);
+            rec[MULTICALL_REC_STATUS] = seL4_FailedLookup;
+            result = seL4_FailedLookup;
+            break;
+        }
+
+        /* Only kernel objects: anything that could block or transfer to
+         * another thread has to go through a real IPC */
+        switch (cap_get_capType(lu_ret.cap)) {
+        case cap_endpoint_cap:
+        case cap_notification_cap:
+        case cap_reply_cap:
+            userError("Multicall: IPC caps cannot be batched.");
+            rec[MULTICALL_REC_STATUS] = seL4_InvalidCapability;
+            result = seL4_InvalidCapability;
+            break;
+        default:
+            break;
+        }
+        if (unlikely(result != seL4_NoError)) {
+            break;
+        }
+
+        status = multicallLookupExtraCaps(thread, &rec[MULTICALL_REC_ARGS + length], extra);
+        if (unlikely(status != EXCEPTION_NONE)) {
+            userError("Multicall: lookup of extra caps failed.");
+            rec[MULTICALL_REC_STATUS] = seL4_FailedLookup;
+            result = seL4_FailedLookup;
+            break;
+        }
+
+        /* The decoders read the first message words from registers and the
+         * rest from buffer[i + 1], so present the record as an IPC buffer
+         * whose message starts at MULTICALL_REC_ARGS. */
+        for (i = 0; i < MIN(length, n_msgRegisters); i++) {
+            setRegister(thread, msgRegisters[i], rec[MULTICALL_REC_ARGS + i]);
+        }
+
+        /* ksKernelEntry is left alone: one kernel entry runs the whole
+         * batch, so it is recorded under SysMulticall rather than charged
+         * to whichever record happened to come last */
+        setThreadState(thread, ThreadState_Restart);
+        TRACE_POINT_START(TRACE_POINT_DECODE_INVOCATION);
+        status = decodeInvocation(seL4_MessageInfo_get_label(info), length,
+                                  rec[MULTICALL_REC_CPTR], lu_ret.slot, lu_ret.cap,
+                                  current_extra_caps, false, false,
+                                  &rec[MULTICALL_REC_INFO]);
+        TRACE_POINT_STOP(TRACE_POINT_DECODE_INVOCATION);
+
+        if (unlikely(status == EXCEPTION_PREEMPTED)) {
+            /* The record is still pending and the thread is in Restart, so
+             * it will pick up from here once the interrupt is handled */
+            return EXCEPTION_PREEMPTED;
+        }
+
+        if (unlikely(status == EXCEPTION_SYSCALL_ERROR)) {
+            rec[MULTICALL_REC_STATUS] = current_syscall_error.type;
+            result = current_syscall_error.type;
+            break;
+        }
+        rec[MULTICALL_REC_STATUS] = seL4_NoError;
+
+        /* The invocation suspended or otherwise retired the caller */
+        tsType = thread_state_get_tsType(thread->tcbState);
+        if (tsType != ThreadState_Restart && tsType != ThreadState_Running) {
+            return EXCEPTION_NONE;
+        }
+
+        if (done + 1 < count && preemptionPoint() == EXCEPTION_PREEMPTED) {
+            setThreadState(thread, ThreadState_Restart);
+            return EXCEPTION_PREEMPTED;
+        }
+    }
+
+    setThreadState(thread, ThreadState_Running);
+    setRegister(thread, capRegister, result);
+    setRegister(thread, msgInfoRegister, done);
+
+    return EXCEPTION_NONE;
+}
+#endif /* CONFIG_MULTICALL */
+
 static void
 handleReply(void)
 {
@@ -672,6 +991,138 @@ handleRecv(bool_t isBlocking)
     }
 }
 
+#ifdef CONFIG_IRQ_ACK_WAIT
+/* Acknowledge the IRQ handler cap in the cap register and wait on the
+ * notification it signals, in one kernel entry. The notification must be
+ * the caller's bound notification, which is what gives the caller the
+ * right to wait on it. Nothing can run between the unmask and the wait,
+ * so an interrupt that arrives straight away is simply picked up by it. */
+static void
+handleIRQAckWait(void)
+{
+    word_t irqCPtr;
+    lookupCap_ret_t lu_ret;
+    cap_t ntfnCap;
+    notification_t *ntfnPtr;
+    irq_t irq;
+
+    irqCPtr = getRegister(NODE_STATE(ksCurThread), capRegister);
+
+    lu_ret = lookupCap(NODE_STATE(ksCurThread), irqCPtr);
+    if (unlikely(lu_ret.status != EXCEPTION_NONE)) {
+        /* current_lookup_fault has been set by lookupCap */
+        current_fault = seL4_Fault_CapFault_new(irqCPtr, false);
+        handleFault(NODE_STATE(ksCurThread));
+        return;
+    }
+
+    if (unlikely(cap_get_capType(lu_ret.cap) != cap_irq_handler_cap)) {
+        userError("IRQAckWait: cap #%lu is not an IRQ handler.", irqCPtr);
+        current_lookup_fault = lookup_fault_missing_capability_new(0);
+        current_fault = seL4_Fault_CapFault_new(irqCPtr, false);
+        handleFault(NODE_STATE(ksCurThread));
+        return;
+    }
+
+    irq = cap_irq_handler_cap_get_capIRQ(lu_ret.cap);
+    ntfnCap = intStateIRQNode[irq].cap;
+    ntfnPtr = NODE_STATE(ksCurThread)->tcbBoundNotification;
+    if (unlikely(cap_get_capType(ntfnCap) != cap_notification_cap || ntfnPtr == NULL ||
+                 NTFN_PTR(cap_notification_cap_get_capNtfnPtr(ntfnCap)) != ntfnPtr)) {
+        userError("IRQAckWait: IRQ %d does not signal the caller's bound notification.", (int) irq);
+        current_lookup_fault = lookup_fault_missing_capability_new(0);
+        current_fault = seL4_Fault_CapFault_new(irqCPtr, false);
+        handleFault(NODE_STATE(ksCurThread));
+        return;
+    }
+
+    invokeIRQHandler_AckIRQ(irq);
+    receiveSignal(NODE_STATE(ksCurThread), ntfnCap, true);
+}
+#endif /* CONFIG_IRQ_ACK_WAIT */
+
+#ifdef CONFIG_NTFN_USER_WORD
+static void
+handleNtfnSetUserWord(void)
+{
+    word_t ntfn_cptr = getRegister(NODE_STATE(ksCurThread), capRegister);
+    word_t frame_cptr = getRegister(NODE_STATE(ksCurThread), msgInfoRegister);
+    word_t offset = getRegister(NODE_STATE(ksCurThread), msgRegisters[0]);
+
+    if (ntfnSetUserWord(ntfn_cptr, frame_cptr, offset) != EXCEPTION_NONE) {
+        setRegister(NODE_STATE(ksCurThread), capRegister, seL4_IllegalOperation);
+        return;
+    }
+    setRegister(NODE_STATE(ksCurThread), capRegister, seL4_NoError);
+}
+#endif /* CONFIG_NTFN_USER_WORD */
+
+#ifdef CONFIG_WAIT_SET
+static void
+handleWaitSetJoin(void)
+{
+    word_t set_cptr = getRegister(NODE_STATE(ksCurThread), capRegister);
+    word_t member_cptr = getRegister(NODE_STATE(ksCurThread), msgInfoRegister);
+    word_t bit = getRegister(NODE_STATE(ksCurThread), msgRegisters[0]);
+
+    if (waitSetJoin(set_cptr, member_cptr, bit) != EXCEPTION_NONE) {
+        setRegister(NODE_STATE(ksCurThread), capRegister, seL4_IllegalOperation);
+        return;
+    }
+    setRegister(NODE_STATE(ksCurThread), capRegister, seL4_NoError);
+}
+
+/* Receive one fired member of a wait set: the member's bit is returned in
+ * the msgInfo register and its badge in the badge register. A set whose
+ * last member has left is received from as a plain notification, with
+ * WAIT_SET_NO_MEMBER in the msgInfo register. */
+static void
+handleWaitSetRecv(void)
+{
+    word_t setCPtr;
+    lookupCap_ret_t lu_ret;
+    tcb_t *boundTCB;
+
+    setCPtr = getRegister(NODE_STATE(ksCurThread), capRegister);
+
+    lu_ret = lookupCap(NODE_STATE(ksCurThread), setCPtr);
+    if (unlikely(lu_ret.status != EXCEPTION_NONE)) {
+        /* current_lookup_fault has been set by lookupCap */
+        current_fault = seL4_Fault_CapFault_new(setCPtr, true);
+        handleFault(NODE_STATE(ksCurThread));
+        return;
+    }
+
+    if (unlikely(cap_get_capType(lu_ret.cap) != cap_notification_cap ||
+                 !cap_notification_cap_get_capNtfnCanReceive(lu_ret.cap))) {
+        userError("WaitSetRecv: cap #%lu is not a receivable notification.", setCPtr);
+        current_lookup_fault = lookup_fault_missing_capability_new(0);
+        current_fault = seL4_Fault_CapFault_new(setCPtr, true);
+        handleFault(NODE_STATE(ksCurThread));
+        return;
+    }
+
+    if (receiveWaitSet(NODE_STATE(ksCurThread), lu_ret.cap)) {
+        return;
+    }
+
+    /* As handleRecv for a notification. The msgInfo register is set first
+     * so that it is also right if the thread blocks and a plain signal
+     * wakes it. */
+    boundTCB = (tcb_t *)notification_ptr_get_ntfnBoundTCB(
+                   NTFN_PTR(cap_notification_cap_get_capNtfnPtr(lu_ret.cap)));
+    if (unlikely(boundTCB && boundTCB != NODE_STATE(ksCurThread))) {
+        current_lookup_fault = lookup_fault_missing_capability_new(0);
+        current_fault = seL4_Fault_CapFault_new(setCPtr, true);
+        handleFault(NODE_STATE(ksCurThread));
+        return;
+    }
+
+    setRegister(NODE_STATE(ksCurThread), msgInfoRegister, WAIT_SET_NO_MEMBER);
+    receiveSignal(NODE_STATE(ksCurThread), lu_ret.cap, true);
+}
+#endif /* CONFIG_WAIT_SET */
+
 static void
 handleYield(void)
 {
@@ -741,8 +1192,44 @@ handleSyscall(syscall_t syscall)
         handleYield();
         break;
 
+#ifdef CONFIG_MULTICALL
+    case SysMulticall:
+        ret = handleMulticall();
+        if (unlikely(ret != EXCEPTION_NONE)) {
+            irq = getActiveIRQ();
+            if (irq != irqInvalid) {
+                handleInterrupt(irq);
+                Arch_finaliseInterrupt();
+            }
+        }
+        break;
+#endif /* CONFIG_MULTICALL */
+
+#ifdef CONFIG_IRQ_ACK_WAIT
+    case SysIRQAckWait:
+        handleIRQAckWait();
+        break;
+#endif /* CONFIG_IRQ_ACK_WAIT */
+
+#ifdef CONFIG_NTFN_USER_WORD
+    case SysNtfnSetUserWord:
+        handleNtfnSetUserWord();
+        break;
+#endif /* CONFIG_NTFN_USER_WORD */
+
+#ifdef CONFIG_WAIT_SET
+    case SysWaitSetJoin:
+        handleWaitSetJoin();
+        break;
+
+    case SysWaitSetRecv:
+        handleWaitSetRecv();
+        break;
+#endif /* CONFIG_WAIT_SET */
+
     default:
-        fail("Invalid syscall");
+        /* In the API range but left out of this configuration */
+        return handleUnknownSyscall(syscall);
     }
 
     schedule();
@@ -763,37 +1250,110 @@ handleSyscall(syscall_t syscall)
  * @TAG(DATA61_GPL)
  */
 
-#ifdef CONFIG_ENABLE_BENCHMARK
+#include <config.h>
 
-#endif /* CONFIG_ENABLE_BENCHMARK */
+#ifdef CONFIG_BENCHMARK_USE_KERNEL_LOG_BUFFER
+#include <benchmark/riscv_benchmark.h>
+#include <benchmark/benchmark.h>
+#include <arch/benchmark.h>
+#include <arch/machine/hardware.h>
+#include <model/statedata.h>
 
+#if CONFIG_MAX_NUM_TRACE_POINTS > 0
+timestamp_t ksEntries[CONFIG_MAX_NUM_TRACE_POINTS];
+bool_t ksStarted[CONFIG_MAX_NUM_TRACE_POINTS];
+timestamp_t ksExit;
+seL4_Word ksLogIndex = 0;
+seL4_Word ksLogIndexFinalized = 0;
+#endif /* CONFIG_MAX_NUM_TRACE_POINTS > 0 */
 
-#line 1 "/home/sandip/Desktop/test/seL/kernel/src/arch/riscv/api/faults.c"
-/*
- * Copyright 2018, Data61
- * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
- * ABN 41 687 119 230.
- *
- * This software may be distributed and modified according to the terms of
- * the GNU General Public License version 2. Note that NO WARRANTY is provided.
- * See "LICENSE_GPLv2.txt" for details.
- *
- * @TAG(DATA61_GPL)
- */
+extern pte_t kernel_log_level2_pt[BIT(PT_INDEX_BITS)];
 
-/*
- *
- * Copyright 2016, 2017 Hesham Almatary, Data61/CSIRO <hesham.almatary@data61.csiro.au>
- * Copyright 2015, 2016 Hesham Almatary <heshamelmatary@gmail.com>
- */
+exception_t
+benchmark_arch_map_logBuffer(word_t frame_cptr)
+{
+    lookupCap_ret_t lu_ret;
+    vm_page_size_t frameSize;
+    pptr_t frame_pptr;
 
-#include <types.h>
-#include <object.h>
-#include <kernel/vspace.h>
-#include <api/faults.h>
-#include <api/syscall.h>
+    /* faulting section */
+    lu_ret = lookupCap(NODE_STATE(ksCurThread), frame_cptr);
 
-#include <types.h>
+    if (unlikely(lu_ret.status != EXCEPTION_NONE)) {
+        userError("Invalid cap #%lu.", frame_cptr);
+        current_fault = seL4_Fault_CapFault_new(frame_cptr, false);
+
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    if (cap_get_capType(lu_ret.cap) != cap_frame_cap) {
+        userError("Invalid cap. Log buffer should be of a frame cap");
+        current_fault = seL4_Fault_CapFault_new(frame_cptr, false);
+
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    frameSize = cap_frame_cap_get_capFSize(lu_ret.cap);
+
+    if (frameSize != RISCV_Mega_Page) {
+        userError("Invalid frame size. The kernel expects a 2M log buffer");
+        current_fault = seL4_Fault_CapFault_new(frame_cptr, false);
+
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    frame_pptr = cap_frame_cap_get_capFBasePtr(lu_ret.cap);
+
+    ksUserLogBuffer = addrFromPPtr((void *) frame_pptr);
+
+    /* The level 2 table covering KS_LOG_PPTR is hooked into the kernel
+     * root table at boot, so every address space already sees it and
+     * only the leaf has to be replaced here. */
+    kernel_log_level2_pt[RISCV_GET_PT_INDEX(KS_LOG_PPTR, 2)] =
+        pte_new(ksUserLogBuffer >> seL4_PageBits,
+                0, /* sw */
+                1, /* dirty */
+                1, /* accessed */
+                1, /* global */
+                0, /* user */
+                0, /* execute */
+                1, /* write */
+                1, /* read */
+                1  /* valid */
+               );
+    sfence();
+
+    return EXCEPTION_NONE;
+}
+#endif /* CONFIG_BENCHMARK_USE_KERNEL_LOG_BUFFER */
+
+
+#line 1 "/home/sandip/Desktop/test/seL/kernel/src/arch/riscv/api/faults.c"
+/*
+ * Copyright 2018, Data61
+ * Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+ * ABN 41 687 119 230.
+ *
+ * This software may be distributed and modified according to the terms of
+ * the GNU General Public License version 2. Note that NO WARRANTY is provided.
+ * See "LICENSE_GPLv2.txt" for details.
+ *
+ * @TAG(DATA61_GPL)
+ */
+
+/*
+ *
+ * Copyright 2016, 2017 Hesham Almatary, Data61/CSIRO <hesham.almatary@data61.csiro.au>
+ * Copyright 2015, 2016 Hesham Almatary <heshamelmatary@gmail.com>
+ */
+
+#include <types.h>
+#include <object.h>
+#include <kernel/vspace.h>
+#include <api/faults.h>
+#include <api/syscall.h>
+
+#include <types.h>
 #include <machine/io.h>
 #include <api/faults.h>
 #include <api/syscall.h>
@@ -858,11 +1418,46 @@ Arch_setMRs_fault(tcb_t *sender, tcb_t* receiver, word_t *receiveIPCBuffer, word
 #include <benchmark/benchmark_track.h>
 #include <benchmark/benchmark_utilisation.h>
 
+#ifdef CONFIG_KERNEL_PRINT_BUFFER
+bool_t printBufferPending(void);
+void printBufferFlush(word_t max);
+#endif
+
+#ifdef CONFIG_IRQ_STATISTICS
+void irqStatsEntry(void);
+void irqStatsExit(void);
+#endif
+
+#ifdef CONFIG_BENCHMARK_LATENCY_HISTOGRAMS
+void latencyHistEntry(word_t path, syscall_t syscall);
+void latencyHistExit(void);
+#endif
+
+#ifdef CONFIG_FASTPATH_VM_FAULT
+void fastpath_vm_fault(word_t scause);
+#endif
+
+#ifdef CONFIG_IRQ_ACK_WAIT
+void fastpath_irq_ack_wait(word_t cptr, word_t msgInfo);
+#endif
+
 /** DONT_TRANSLATE */
-void VISIBLE NORETURN restore_user_context(void)
+SECTION(".text.hot") void VISIBLE NORETURN restore_user_context(void)
 {
     word_t cur_thread_reg = (word_t) NODE_STATE(ksCurThread)->tcbArch.tcbContext.registers;
 
+#ifdef CONFIG_KERNEL_PRINT_BUFFER
+    printBufferFlush(CONFIG_KERNEL_PRINT_FLUSH_CHUNK);
+#endif
+
+#ifdef CONFIG_IRQ_STATISTICS
+    irqStatsExit();
+#endif
+
+#ifdef CONFIG_BENCHMARK_LATENCY_HISTOGRAMS
+    latencyHistExit();
+#endif
+
     c_exit_hook();
 
     NODE_UNLOCK_IF_HELD;
@@ -925,33 +1520,50 @@ void VISIBLE NORETURN restore_user_context(void)
     UNREACHABLE();
 }
 
-void VISIBLE NORETURN
+SECTION(".text.hot") void VISIBLE NORETURN
 c_handle_interrupt(void)
 {
     NODE_LOCK_IRQ;
 
     c_entry_hook();
 
+#ifdef CONFIG_BENCHMARK_LATENCY_HISTOGRAMS
+    latencyHistEntry(Entry_Interrupt, 0);
+#endif
+
+#ifdef CONFIG_IRQ_STATISTICS
+    irqStatsEntry();
+#endif
+
     handleInterruptEntry();
 
     restore_user_context();
     UNREACHABLE();
 }
 
-void VISIBLE NORETURN
+SECTION(".text.hot") void VISIBLE NORETURN
 c_handle_exception(void)
 {
     NODE_LOCK_SYS;
 
     c_entry_hook();
 
+#ifdef CONFIG_BENCHMARK_LATENCY_HISTOGRAMS
+    latencyHistEntry(Entry_UserLevelFault, 0);
+#endif
+
+#ifdef CONFIG_FASTPATH_VM_FAULT
+    /* Only returns if the fault has to take the slowpath */
+    fastpath_vm_fault(read_scause());
+#endif
+
     handle_exception();
 
     restore_user_context();
     UNREACHABLE();
 }
 
-void NORETURN
+SECTION(".text.hot") void NORETURN
 slowpath(syscall_t syscall)
 {
     /* check for undefined syscall */
@@ -965,13 +1577,17 @@ slowpath(syscall_t syscall)
     UNREACHABLE();
 }
 
-void VISIBLE NORETURN
+SECTION(".text.hot") void VISIBLE NORETURN
 c_handle_syscall(word_t cptr, word_t msgInfo, word_t unused1, word_t unused2, word_t unused3, word_t unused4, word_t unused5, syscall_t syscall)
 {
     NODE_LOCK_SYS;
 
     c_entry_hook();
 
+#ifdef CONFIG_BENCHMARK_LATENCY_HISTOGRAMS
+    latencyHistEntry(Entry_Syscall, syscall);
+#endif
+
 #ifdef CONFIG_FASTPATH
     if (syscall == (syscall_t)SysCall) {
         fastpath_call(cptr, msgInfo);
@@ -980,6 +1596,12 @@ c_handle_syscall(word_t cptr, word_t msgInfo, word_t unused1, word_t unused2, wo
         fastpath_reply_recv(cptr, msgInfo);
         UNREACHABLE();
     }
+#ifdef CONFIG_IRQ_ACK_WAIT
+    else if (syscall == (syscall_t)SysIRQAckWait) {
+        fastpath_irq_ack_wait(cptr, msgInfo);
+        UNREACHABLE();
+    }
+#endif /* CONFIG_IRQ_ACK_WAIT */
 #endif /* CONFIG_FASTPATH */
     slowpath(syscall);
     UNREACHABLE();
@@ -1009,6 +1631,18 @@ c_handle_syscall(word_t cptr, word_t msgInfo, word_t unused1, word_t unused2, wo
 void idle_thread(void)
 {
     while (1) {
+#ifdef CONFIG_KERNEL_PRINT_BUFFER
+        /* The idle thread runs in supervisor mode, so it can drain kernel
+         * output that the exit path left behind. Interrupts are held off
+         * for one chunk at a time so a kernel entry never sees the ring
+         * half updated. */
+        if (printBufferPending()) {
+            asm volatile("csrc sstatus, %0" :: "rK"(SSTATUS_SIE) : "memory");
+            printBufferFlush(CONFIG_KERNEL_PRINT_FLUSH_CHUNK);
+            asm volatile("csrs sstatus, %0" :: "rK"(SSTATUS_SIE) : "memory");
+            continue;
+        }
+#endif
         asm volatile("wfi");
     }
 }
@@ -1020,6 +1654,10 @@ void VISIBLE halt(void)
     printf("halting...");
 #endif
 
+#ifdef CONFIG_KERNEL_PRINT_BUFFER
+    printBufferFlush(BIT(CONFIG_KERNEL_PRINT_BUFFER_BITS));
+#endif
+
     sbi_shutdown();
 
     UNREACHABLE();
@@ -1459,14 +2097,18 @@ init_kernel(
 #include <arch/model/statedata.h>
 #include <arch/kernel/vspace.h>
 #include <arch/kernel/thread.h>
+#include <benchmark/benchmark.h>
+#include <benchmark/kernel_tracepoints.h>
 #include <linker.h>
 
 extern char kernel_stack_alloc[CONFIG_MAX_NUM_NODES][BIT(CONFIG_KERNEL_STACK_BITS)];
 
-void
+SECTION(".text.hot") void
 Arch_switchToThread(tcb_t *tcb)
 {
+    TRACE_POINT_START(TRACE_POINT_SET_VM_ROOT);
     setVMRoot(tcb);
+    TRACE_POINT_STOP(TRACE_POINT_SET_VM_ROOT);
     setRegister(tcb, tp, tcb->tcbIPCBuffer);
 }
 
@@ -1522,6 +2164,7 @@ Arch_postModifyRegisters(tcb_t *tptr)
  */
 
 #include <types.h>
+#include <benchmark/riscv_benchmark.h>
 #include <benchmark/benchmark.h>
 #include <api/failures.h>
 #include <api/syscall.h>
@@ -1550,6 +2193,13 @@ struct resolve_ret {
 typedef struct resolve_ret resolve_ret_t;
 
 static exception_t performPageGetAddress(void *vbase_ptr);
+static exception_t performPageTableInvocationMapFrames(asid_t asid, pte_t *lvl1pt,
+                                                       cte_t *slots, word_t count,
+                                                       vptr_t vaddr, vm_page_size_t frameSize,
+                                                       seL4_CapRights_t rightsMask,
+                                                       bool_t executable);
+static exception_t performPageTableInvocationTeardown(cap_t cap, cte_t *ctSlot);
+static exception_t performPageFlush(word_t label, paddr_t pstart, paddr_t pend);
 
 static word_t CONST
 RISCVGetWriteFromVMRights(vm_rights_t vm_rights)
@@ -1644,6 +2294,15 @@ map_kernel_window(void)
 
     /* There should be 1GiB free where we will put device mapping some day */
     assert(pptr == UINTPTR_MAX - RISCV_GET_LVL_PGSIZE(1) + 1);
+
+#ifdef CONFIG_BENCHMARK_USE_KERNEL_LOG_BUFFER
+    /* Until then the log buffer lives there. The level 2 table is installed
+     * now so that it is copied into every vspace; its leaf is filled in by
+     * benchmark_arch_map_logBuffer */
+    assert(KS_LOG_PPTR >= pptr);
+    kernel_root_pageTable[RISCV_GET_PT_INDEX(KS_LOG_PPTR, 1)] =
+        pte_next(kpptr_to_paddr(kernel_log_level2_pt), false);
+#endif
 }
 
 BOOT_CODE void
@@ -2077,7 +2736,43 @@ unmapPage(vm_page_size_t page_size, asid_t asid, vptr_t vptr, pptr_t pptr)
     sfence();
 }
 
-void
+#ifdef ENABLE_SMP_SUPPORT
+/* Harts that were idle when an instruction cache was last unified, and
+ * still owe a fence.i before they run a user thread again */
+static word_t riscvICacheStale;
+#endif
+
+/* Make stores to memory visible to instruction fetch on every hart. Only
+ * the harts running a thread are sent a remote fence.i; an idle hart
+ * fetches nothing from user frames, so it fences when it next switches
+ * to a thread instead. Core indices are used as hart ids. */
+static void
+unifyInstructionCache(void)
+{
+    __asm__ volatile("fence.i" ::: "memory");
+
+#ifdef ENABLE_SMP_SUPPORT
+    unsigned long hart_mask = 0;
+    word_t i;
+
+    for (i = 0; i < CONFIG_MAX_NUM_NODES; i++) {
+        if (i == getCurrentCPUIndex()) {
+            continue;
+        }
+        if (NODE_STATE_ON_CORE(ksCurThread, i) == NODE_STATE_ON_CORE(ksIdleThread, i)) {
+            riscvICacheStale |= BIT(i);
+        } else {
+            hart_mask |= BIT(i);
+        }
+    }
+
+    if (hart_mask != 0) {
+        sbi_remote_fence_i(&hart_mask);
+    }
+#endif
+}
+
+SECTION(".text.hot") void
 setVMRoot(tcb_t *tcb)
 {
     cap_t threadRoot;
@@ -2085,6 +2780,13 @@ setVMRoot(tcb_t *tcb)
     pte_t *lvl1pt;
     findVSpaceForASID_ret_t  find_ret;
 
+#ifdef ENABLE_SMP_SUPPORT
+    if (unlikely(riscvICacheStale & BIT(getCurrentCPUIndex()))) {
+        riscvICacheStale &= ~BIT(getCurrentCPUIndex());
+        __asm__ volatile("fence.i" ::: "memory");
+    }
+#endif
+
     threadRoot = TCB_PTR_CTE_PTR(tcb, tcbVTable)->cap;
 
     if (cap_get_capType(threadRoot) != cap_page_table_cap) {
@@ -2188,11 +2890,195 @@ checkVPAlignment(vm_page_size_t sz, word_t w)
     return (w & MASK(pageBitsForSize(sz))) == 0;
 }
 
+static exception_t
+decodeRISCVPageTableMapFrames(unsigned int length, cap_t cap,
+                              extra_caps_t extraCaps, word_t *buffer)
+{
+    word_t index, count, vaddr, w_rightsMask, nslots, frameBits, i;
+    vm_attributes_t attr;
+    cap_t cnodeCap;
+    pte_t *lvl1pt, *ptSlot;
+    asid_t asid;
+    findVSpaceForASID_ret_t find_ret;
+    cte_t *slots;
+    vm_page_size_t frameSize;
+    vptr_t frameVaddr;
+
+    if (unlikely(length < 5 || extraCaps.excaprefs[0] == NULL)) {
+        userError("RISCVPageTableMapFrames: Truncated message.");
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    index = getSyscallArg(0, buffer);
+    count = getSyscallArg(1, buffer);
+    vaddr = getSyscallArg(2, buffer);
+    w_rightsMask = getSyscallArg(3, buffer);
+    attr = vmAttributesFromWord(getSyscallArg(4, buffer));
+    cnodeCap = extraCaps.excaprefs[0]->cap;
+
+    if (unlikely(cap_page_table_cap_get_capPTMappedASID(cap) == asidInvalid)) {
+        userError("RISCVPageTableMapFrames: PageTable is not a VSpace root.");
+        current_syscall_error.type = seL4_InvalidCapability;
+        current_syscall_error.invalidCapNumber = 0;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    lvl1pt = PTE_PTR(cap_page_table_cap_get_capPTBasePtr(cap));
+    asid = cap_page_table_cap_get_capPTMappedASID(cap);
+
+    find_ret = findVSpaceForASID(asid);
+    if (unlikely(find_ret.status != EXCEPTION_NONE)) {
+        userError("RISCVPageTableMapFrames: No PageTable for ASID");
+        current_syscall_error.type = seL4_FailedLookup;
+        current_syscall_error.failedLookupWasSource = false;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    if (unlikely(find_ret.vspace_root != lvl1pt)) {
+        userError("RISCVPageTableMapFrames: PageTable is not a VSpace root.");
+        current_syscall_error.type = seL4_InvalidCapability;
+        current_syscall_error.invalidCapNumber = 0;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    if (unlikely(cap_get_capType(cnodeCap) != cap_cnode_cap)) {
+        userError("RISCVPageTableMapFrames: Frames must come from a CNode.");
+        current_syscall_error.type = seL4_InvalidCapability;
+        current_syscall_error.invalidCapNumber = 1;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    nslots = BIT(cap_cnode_cap_get_capCNodeRadix(cnodeCap));
+    if (unlikely(index >= nslots)) {
+        userError("RISCVPageTableMapFrames: Slot index out of range.");
+        current_syscall_error.type = seL4_InvalidArgument;
+        current_syscall_error.invalidArgumentNumber = 0;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    /* Every slot is checked here, before anything is mapped, so the run
+     * is bounded like the destination slots of a Retype */
+    if (unlikely(count == 0 || count > nslots - index ||
+                 count > CONFIG_RETYPE_FAN_OUT_LIMIT)) {
+        userError("RISCVPageTableMapFrames: Slot range is empty, too long or runs off the end of the CNode.");
+        current_syscall_error.type = seL4_RangeError;
+        current_syscall_error.rangeErrorMin = 1;
+        current_syscall_error.rangeErrorMax = MIN(nslots - index, CONFIG_RETYPE_FAN_OUT_LIMIT);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    /* Every frame in the run must be the size of the first one */
+    slots = CTE_PTR(cap_cnode_cap_get_capCNodePtr(cnodeCap)) + index;
+    if (unlikely(cap_get_capType(slots[0].cap) != cap_frame_cap)) {
+        userError("RISCVPageTableMapFrames: First slot does not hold a frame.");
+        current_syscall_error.type = seL4_InvalidCapability;
+        current_syscall_error.invalidCapNumber = 1;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+    frameSize = cap_frame_cap_get_capFSize(slots[0].cap);
+    frameBits = pageBitsForSize(frameSize);
+
+    if (unlikely(vaddr >= PPTR_USER_TOP ||
+                 count > (PPTR_USER_TOP - vaddr) >> frameBits)) {
+        userError("RISCVPageTableMapFrames: Range cannot be in kernel window.");
+        current_syscall_error.type = seL4_InvalidArgument;
+        current_syscall_error.invalidArgumentNumber = 2;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+    if (unlikely(!checkVPAlignment(frameSize, vaddr))) {
+        current_syscall_error.type = seL4_AlignmentError;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    /* Check every frame and the entry it goes into. A frame that is
+     * already mapped at its place in the run was mapped by an earlier,
+     * preempted attempt and is skipped by the mapping. */
+    ptSlot = NULL;
+    frameVaddr = vaddr;
+    for (i = 0; i < count; i++, frameVaddr += BIT(frameBits)) {
+        cap_t frameCap = slots[i].cap;
+        bool_t mappedHere;
+
+        if (ptSlot == NULL || ((frameVaddr >> frameBits) & MASK(PT_INDEX_BITS)) == 0) {
+            lookupPTSlot_ret_t lu_ret = lookupPTSlot(lvl1pt, frameVaddr);
+            if (unlikely(lu_ret.ptBitsLeft != frameBits)) {
+                userError("RISCVPageTableMapFrames: No PageTable for this page %p",
+                          (void *) frameVaddr);
+                current_lookup_fault = lookup_fault_missing_capability_new(lu_ret.ptBitsLeft);
+                current_syscall_error.type = seL4_FailedLookup;
+                current_syscall_error.failedLookupWasSource = false;
+                return EXCEPTION_SYSCALL_ERROR;
+            }
+            ptSlot = lu_ret.ptSlot;
+        } else {
+            ptSlot++;
+        }
+
+        if (unlikely(cap_get_capType(frameCap) != cap_frame_cap ||
+                     cap_frame_cap_get_capFSize(frameCap) != frameSize)) {
+            userError("RISCVPageTableMapFrames: Slot %lu of the run is not a matching frame.", i);
+            current_syscall_error.type = seL4_InvalidCapability;
+            current_syscall_error.invalidCapNumber = 1;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+
+        mappedHere = cap_frame_cap_get_capFMappedASID(frameCap) == asid &&
+                     cap_frame_cap_get_capFMappedAddress(frameCap) == frameVaddr;
+        if (mappedHere) {
+            continue;
+        }
+
+        if (unlikely(cap_frame_cap_get_capFMappedASID(frameCap) != asidInvalid)) {
+            userError("RISCVPageTableMapFrames: Slot %lu of the run is already mapped.", i);
+            current_syscall_error.type = seL4_InvalidCapability;
+            current_syscall_error.invalidCapNumber = 1;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+
+        if (unlikely(pte_ptr_get_valid(ptSlot))) {
+            userError("Virtual address already mapped");
+            current_syscall_error.type = seL4_DeleteFirst;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+    }
+
+    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+    return performPageTableInvocationMapFrames(asid, lvl1pt, slots, count, vaddr, frameSize,
+                                               rightsFromWord(w_rightsMask),
+                                               !vm_attributes_get_riscvExecuteNever(attr));
+}
+
 static exception_t
 decodeRISCVPageTableInvocation(word_t label, unsigned int length,
                                cte_t *cte, cap_t cap, extra_caps_t extraCaps,
                                word_t *buffer)
 {
+    if (label == RISCVPageTableMapFrames) {
+        return decodeRISCVPageTableMapFrames(length, cap, extraCaps, buffer);
+    }
+
+    if (label == RISCVPageTableTeardown) {
+        if (unlikely(!isFinalCapability(cte))) {
+            userError("RISCVPageTableTeardown: cannot tear down if more than one cap exists");
+            current_syscall_error.type = seL4_RevokeFirst;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+
+        asid_t asid = cap_page_table_cap_get_capPTMappedASID(cap);
+        findVSpaceForASID_ret_t find_ret = findVSpaceForASID(asid);
+        if (unlikely(asid == asidInvalid || find_ret.status != EXCEPTION_NONE ||
+                     find_ret.vspace_root != PTE_PTR(cap_page_table_cap_get_capPTBasePtr(cap)))) {
+            userError("RISCVPageTableTeardown: PageTable is not a VSpace root.");
+            current_syscall_error.type = seL4_InvalidCapability;
+            current_syscall_error.invalidCapNumber = 0;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+
+        setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+        return performPageTableInvocationTeardown(cap, cte);
+    }
+
     if (label == RISCVPageTableUnmap) {
         if (unlikely(!isFinalCapability(cte))) {
             userError("RISCVPageTableUnmap: cannot unmap if more than once cap exists");
@@ -2481,6 +3367,57 @@ decodeRISCVFrameInvocation(word_t label, unsigned int length,
         return performPageGetAddress((void*)cap_frame_cap_get_capFBasePtr(cap));
     }
 
+    case RISCVPageClean_Data:
+    case RISCVPageInvalidate_Data:
+    case RISCVPageCleanInvalidate_Data:
+    case RISCVPageUnify_Instruction: {
+#ifndef CONFIG_RISCV_ZICBOM
+        /* Without Zicbom a data cache range cannot be cleaned or
+         * invalidated, so do not claim to have done it */
+        if (unlikely(label != RISCVPageUnify_Instruction)) {
+            userError("RISCVPage Flush: Data cache operations need Zicbom.");
+            current_syscall_error.type = seL4_IllegalOperation;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+#endif
+
+        if (unlikely(length < 2)) {
+            userError("RISCVPage Flush: Truncated message.");
+            current_syscall_error.type = seL4_TruncatedMessage;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+
+        word_t start = getSyscallArg(0, buffer);
+        word_t end = getSyscallArg(1, buffer);
+        vm_page_size_t frameSize = cap_frame_cap_get_capFSize(cap);
+
+        /* check that the range is inside the frame */
+        if (unlikely(end <= start)) {
+            userError("RISCVPage Flush: Invalid range.");
+            current_syscall_error.type = seL4_InvalidArgument;
+            current_syscall_error.invalidArgumentNumber = 1;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+        if (unlikely(end > BIT(pageBitsForSize(frameSize)))) {
+            userError("RISCVPage Flush: Requested range not inside page.");
+            current_syscall_error.type = seL4_InvalidArgument;
+            current_syscall_error.invalidArgumentNumber = 0;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+
+        /* invalidating discards whatever was written through the cache */
+        if (unlikely(label == RISCVPageInvalidate_Data &&
+                     cap_frame_cap_get_capFVMRights(cap) != VMReadWrite)) {
+            userError("RISCVPage Flush: Invalidate needs a writable frame cap.");
+            current_syscall_error.type = seL4_IllegalOperation;
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+
+        paddr_t frame_paddr = addrFromPPtr((void *) cap_frame_cap_get_capFBasePtr(cap));
+        setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+        return performPageFlush(label, frame_paddr + start, frame_paddr + end - 1);
+    }
+
     default:
         userError("RISCVPage: Illegal operation.");
         current_syscall_error.type = seL4_IllegalOperation;
@@ -2668,6 +3605,35 @@ performPageTableInvocationUnmap(cap_t cap, cte_t *ctSlot)
     return EXCEPTION_NONE;
 }
 
+/* Detach everything mapped into a VSpace by clearing the user entries of its
+ * root, then release the ASID, which is the only TLB flush needed. From then
+ * on unmapPage and unmapPageTable for the old mappings fail the ASID lookup
+ * straight away, so the frame and page table caps can be deleted or unmapped
+ * later without any walks or fences of their own. A preempted call restarts
+ * with the ASID still bound and skips the entries already cleared. */
+static exception_t
+performPageTableInvocationTeardown(cap_t cap, cte_t *ctSlot)
+{
+    pte_t *lvl1pt = PTE_PTR(cap_page_table_cap_get_capPTBasePtr(cap));
+    word_t i;
+
+    for (i = 0; i < (PPTR_USER_TOP >> RISCV_GET_LVL_PGSIZE_BITS(1)); i++) {
+        if (pte_ptr_get_valid(lvl1pt + i)) {
+            lvl1pt[i] = pte_pte_invalid_new();
+            if (preemptionPoint() == EXCEPTION_PREEMPTED) {
+                return EXCEPTION_PREEMPTED;
+            }
+        }
+    }
+
+    deleteASID(cap_page_table_cap_get_capPTMappedASID(cap), lvl1pt);
+
+    cap = cap_page_table_cap_set_capPTMappedASID(ctSlot->cap, asidInvalid);
+    ctSlot->cap = cap_page_table_cap_set_capPTIsMapped(cap, 0);
+
+    return EXCEPTION_NONE;
+}
+
 static exception_t
 performPageGetAddress(void *vbase_ptr)
 {
@@ -2684,12 +3650,40 @@ performPageGetAddress(void *vbase_ptr)
     return EXCEPTION_NONE;
 }
 
-static exception_t updatePTE(pte_t pte, pte_t *base)
+/* pend is the last byte of the range */
+static exception_t
+performPageFlush(word_t label, paddr_t pstart, paddr_t pend)
 {
-    *base = pte;
-    sfence();
-    return EXCEPTION_NONE;
-}
+    switch (label) {
+#ifdef CONFIG_RISCV_ZICBOM
+    case RISCVPageClean_Data:
+        plat_cleanL2Range(pstart, pend);
+        break;
+
+    case RISCVPageInvalidate_Data:
+        plat_invalidateL2Range(pstart, pend);
+        break;
+
+    case RISCVPageCleanInvalidate_Data:
+        plat_cleanInvalidateL2Range(pstart, pend);
+        break;
+#endif /* CONFIG_RISCV_ZICBOM */
+
+    case RISCVPageUnify_Instruction:
+        /* fence.i also orders the data side, nothing needs cleaning */
+        unifyInstructionCache();
+        break;
+    }
+
+    return EXCEPTION_NONE;
+}
+
+static exception_t updatePTE(pte_t pte, pte_t *base)
+{
+    *base = pte;
+    sfence();
+    return EXCEPTION_NONE;
+}
 
 exception_t performPageInvocationMapPTE(cap_t cap, cte_t *ctSlot,
                                         pte_t pte, pte_t *base)
@@ -2704,6 +3698,58 @@ performPageInvocationRemapPTE(pte_t pte, pte_t *base)
     return updatePTE(pte, base);
 }
 
+/* Map a run of frames at consecutive addresses. The walk from the root is
+ * only repeated when the run crosses into another leaf table, and a single
+ * sfence covers every entry written.
+ *
+ * decodeRISCVPageTableMapFrames has checked every frame and entry, so
+ * nothing here can fail. Progress lives in the frame caps themselves: a
+ * frame already mapped at its place in the run is skipped, which lets a
+ * preempted call simply be restarted. */
+static exception_t
+performPageTableInvocationMapFrames(asid_t asid, pte_t *lvl1pt, cte_t *slots, word_t count,
+                                    vptr_t vaddr, vm_page_size_t frameSize,
+                                    seL4_CapRights_t rightsMask, bool_t executable)
+{
+    word_t frameBits = pageBitsForSize(frameSize);
+    pte_t *ptSlot = NULL;
+    exception_t status = EXCEPTION_NONE;
+    word_t i;
+
+    for (i = 0; i < count; i++, vaddr += BIT(frameBits)) {
+        cap_t cap = slots[i].cap;
+        vm_rights_t vmRights;
+        paddr_t frame_paddr;
+
+        if (ptSlot == NULL || ((vaddr >> frameBits) & MASK(PT_INDEX_BITS)) == 0) {
+            lookupPTSlot_ret_t lu_ret = lookupPTSlot(lvl1pt, vaddr);
+            assert(lu_ret.ptBitsLeft == frameBits);
+            ptSlot = lu_ret.ptSlot;
+        } else {
+            ptSlot++;
+        }
+
+        if (cap_frame_cap_get_capFMappedASID(cap) != asidInvalid) {
+            /* mapped by an earlier, preempted attempt */
+            continue;
+        }
+
+        vmRights = maskVMRights(cap_frame_cap_get_capFVMRights(cap), rightsMask);
+        frame_paddr = addrFromPPtr((void *) cap_frame_cap_get_capFBasePtr(cap));
+        cap = cap_frame_cap_set_capFMappedASID(cap, asid);
+        slots[i].cap = cap_frame_cap_set_capFMappedAddress(cap, vaddr);
+        *ptSlot = makeUserPTE(frame_paddr, executable, vmRights);
+
+        if (i + 1 < count && preemptionPoint() == EXCEPTION_PREEMPTED) {
+            status = EXCEPTION_PREEMPTED;
+            break;
+        }
+    }
+
+    sfence();
+    return status;
+}
+
 exception_t
 performPageInvocationUnmap(cap_t cap, cte_t *ctSlot)
 {
@@ -2834,6 +3880,8 @@ setNextPC(tcb_t *thread, word_t v)
 #include <arch/machine.h>
 #include <arch/sbi.h>
 #include <arch/kernel/traps.h>
+#include <kernel/cspace.h>
+#include <model/statedata.h>
 
 static inline void print_format_cause(int cause_num)
 {
@@ -2916,12 +3964,58 @@ void handle_exception(void)
 }
 
 #ifdef CONFIG_PRINTING
+#ifdef CONFIG_RISCV_CONSOLE_MMIO_UART
+/* Shakti UART registers, reached through the kernel window */
+#define UART_REG(off) ((volatile uint32_t *) paddr_to_pptr(CONFIG_RISCV_CONSOLE_UART_PADDR + (off)))
+#define UART_TX       0x4
+#define UART_STATUS   0xc
+#define UART_STATUS_TX_FULL BIT(1)
+
+void
+putConsoleChar(unsigned char c)
+{
+    while (*UART_REG(UART_STATUS) & UART_STATUS_TX_FULL);
+    *UART_REG(UART_TX) = c;
+}
+#else
 void
 putConsoleChar(unsigned char c)
 {
     sbi_console_putchar(c);
 }
-#endif
+#endif /* CONFIG_RISCV_CONSOLE_MMIO_UART */
+
+#ifdef CONFIG_KERNEL_PRINT_BUFFER
+void printBufferSetStorage(void *base, word_t bytes);
+
+exception_t
+setPrintBuffer(word_t frame_cptr)
+{
+    lookupCap_ret_t lu_ret;
+    cap_t frame_cap;
+
+    lu_ret = lookupCap(NODE_STATE(ksCurThread), frame_cptr);
+    if (unlikely(lu_ret.status != EXCEPTION_NONE)) {
+        userError("Invalid cap #%lu.", frame_cptr);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    frame_cap = lu_ret.cap;
+    /* The kernel writes the ring into the frame, so require the rights a
+     * user mapping would need to do the same */
+    if (cap_get_capType(frame_cap) != cap_frame_cap ||
+            cap_frame_cap_get_capFIsDevice(frame_cap) ||
+            cap_frame_cap_get_capFVMRights(frame_cap) != VMReadWrite) {
+        userError("Print buffer must be a writable RAM frame cap.");
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    printBufferSetStorage((void *) cap_frame_cap_get_capFBasePtr(frame_cap),
+                          BIT(pageBitsForSize(cap_frame_cap_get_capFSize(frame_cap))));
+    return EXCEPTION_NONE;
+}
+#endif /* CONFIG_KERNEL_PRINT_BUFFER */
+#endif /* CONFIG_PRINTING */
 #line 1 "/home/sandip/Desktop/test/seL/kernel/src/arch/riscv/machine/registerset.c"
 /*
  * Copyright 2018, Data61
@@ -2992,6 +4086,9 @@ pte_t kernel_root_pageTable[BIT(PT_INDEX_BITS)] ALIGN_BSS(BIT(seL4_PageTableBits
 #ifdef RISCV_KERNEL_WINDOW_LEVEL2_PT
 pte_t kernel_image_level2_pt[BIT(PT_INDEX_BITS)] ALIGN_BSS(BIT(seL4_PageTableBits));
 #endif
+#ifdef CONFIG_BENCHMARK_USE_KERNEL_LOG_BUFFER
+pte_t kernel_log_level2_pt[BIT(PT_INDEX_BITS)] ALIGN_BSS(BIT(seL4_PageTableBits));
+#endif
 #line 1 "/home/sandip/Desktop/test/seL/kernel/src/arch/riscv/object/interrupt.c"
 /*
  * Copyright 2018, Data61
@@ -3057,6 +4154,14 @@ Arch_decodeIRQControlInvocation(word_t invLabel, word_t length,
 #include <arch/model/statedata.h>
 #include <arch/object/objecttype.h>
 
+#ifdef CONFIG_KERNEL_PRINT_BUFFER
+void printBufferRelease(void *base);
+#endif
+
+#ifdef CONFIG_NTFN_USER_WORD
+void ntfnReleaseUserWordFrame(word_t base, word_t bytes);
+#endif
+
 deriveCap_ret_t
 Arch_deriveCap(cte_t *slot, cap_t cap)
 {
@@ -3129,6 +4234,18 @@ Arch_finaliseCap(cap_t cap, bool_t final)
                       cap_frame_cap_get_capFMappedAddress(cap),
                       cap_frame_cap_get_capFBasePtr(cap));
         }
+#ifdef CONFIG_KERNEL_PRINT_BUFFER
+        if (final) {
+            /* Stop printing into a frame that is about to be freed */
+            printBufferRelease((void *) cap_frame_cap_get_capFBasePtr(cap));
+        }
+#endif
+#ifdef CONFIG_NTFN_USER_WORD
+        if (final) {
+            ntfnReleaseUserWordFrame(cap_frame_cap_get_capFBasePtr(cap),
+                                     BIT(pageBitsForSize(cap_frame_cap_get_capFSize(cap))));
+        }
+#endif
         break;
     case cap_page_table_cap:
         if (final) {
@@ -3137,6 +4254,9 @@ Arch_finaliseCap(cap_t cap, bool_t final)
                 findVSpaceForASID_ret_t find_ret = findVSpaceForASID(asid);
                 pte_t *pte = PTE_PTR(cap_page_table_cap_get_capPTBasePtr(cap));
                 if (find_ret.status == EXCEPTION_NONE && find_ret.vspace_root == pte) {
+                    /* Everything still mapped into this VSpace is left for
+                     * the caps to clean up; once the ASID is gone that costs
+                     * them a failed lookup each */
                     deleteASID(cap_page_table_cap_get_capPTMappedASID(cap), pte);
                 } else if (cap_page_table_cap_get_capPTIsMapped(cap)) {
                     unmapPageTable(asid, cap_page_table_cap_get_capPTMappedAddress(cap), pte);
@@ -3434,8 +4554,16 @@ void _assert_fail(
  */
 
 #include <config.h>
+#include <benchmark/riscv_benchmark.h>
 #include <benchmark/benchmark_track.h>
 #include <model/statedata.h>
+#ifdef CONFIG_BENCHMARK_LATENCY_HISTOGRAMS
+#include <api/syscall.h>
+#include <arch/api/invocation.h>
+#include <kernel/vspace.h>
+#include <machine/io.h>
+#include <string.h>
+#endif
 
 #ifdef CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES
 
@@ -3461,6 +4589,186 @@ void benchmark_track_exit(void)
     }
 }
 #endif /* CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES */
+
+#ifdef CONFIG_BENCHMARK_LATENCY_HISTOGRAMS
+
+/* Log2 histograms of kernel entry to exit cycles, for finding the worst
+ * case rather than the average. Syscalls are kept per syscall number,
+ * separately for the fastpath and the slowpath; slot 0 collects the
+ * debug and benchmark syscalls. Slowpath invocations of kernel objects
+ * are also kept per invocation label. User level and VM faults share one
+ * histogram per path, index 0 of their table. A preempted invocation is
+ * recorded once for every kernel entry it takes. Interrupts are not
+ * recorded. */
+#define LATENCY_HIST_BUCKETS 32
+#define LATENCY_HIST_SYSCALLS (-SYSCALL_MIN + 1)
+
+enum latency_hist_table {
+    LATENCY_HIST_SLOWPATH,
+    LATENCY_HIST_FASTPATH,
+    LATENCY_HIST_INVOCATION,
+    LATENCY_HIST_FAULT_SLOWPATH,
+    LATENCY_HIST_FAULT_FASTPATH
+};
+
+enum latency_hist_msg {
+    LATENCY_HIST_COUNT,
+    LATENCY_HIST_MAX,
+    LATENCY_HIST_BUCKET,
+    LATENCY_HIST_MSG_LENGTH = LATENCY_HIST_BUCKET + LATENCY_HIST_BUCKETS
+};
+
+typedef struct latency_hist {
+    word_t count;
+    word_t max;
+    word_t buckets[LATENCY_HIST_BUCKETS];
+} latency_hist_t;
+
+compile_assert(latency_hist_fits_in_ipc_buffer, LATENCY_HIST_MSG_LENGTH <= seL4_MsgMaxLength)
+
+/* indexed by ksKernelEntry.is_fastpath */
+static latency_hist_t latencyHistSyscall[2][LATENCY_HIST_SYSCALLS];
+static latency_hist_t latencyHistInvocation[nArchInvocationLabels];
+static latency_hist_t latencyHistFault[2];
+static word_t latencyHistStart;
+
+static inline word_t
+latencyHistTimestamp(void)
+{
+    word_t cycles;
+    asm volatile("rdcycle %0" : "=r"(cycles));
+    return cycles;
+}
+
+static void
+latencyHistRecord(latency_hist_t *hist, word_t cycles)
+{
+    word_t bucket = cycles ? wordBits - clzl(cycles) : 0;
+
+    if (bucket >= LATENCY_HIST_BUCKETS) {
+        bucket = LATENCY_HIST_BUCKETS - 1;
+    }
+    hist->buckets[bucket]++;
+    hist->count++;
+    if (cycles > hist->max) {
+        hist->max = cycles;
+    }
+}
+
+void
+latencyHistEntry(word_t path, syscall_t syscall)
+{
+    ksKernelEntry.path = path;
+    ksKernelEntry.is_fastpath = false;
+    ksKernelEntry.cap_type = cap_null_cap;
+    ksKernelEntry.invocation_tag = 0;
+    if (path == Entry_Syscall) {
+        if (syscall < SYSCALL_MIN || syscall > SYSCALL_MAX) {
+            ksKernelEntry.path = Entry_UnknownSyscall;
+            ksKernelEntry.syscall_no = 0;
+        } else {
+            ksKernelEntry.syscall_no = -syscall;
+        }
+    }
+    latencyHistStart = latencyHistTimestamp();
+}
+
+void
+latencyHistExit(void)
+{
+    word_t cycles = latencyHistTimestamp() - latencyHistStart;
+    word_t syscall = ksKernelEntry.syscall_no;
+
+    /* c_handle_exception enters every fault, VM faults included, as
+     * Entry_UserLevelFault; fastpath_vm_fault sets is_fastpath */
+    if (ksKernelEntry.path == Entry_UserLevelFault ||
+            ksKernelEntry.path == Entry_VMFault) {
+        latencyHistRecord(&latencyHistFault[ksKernelEntry.is_fastpath], cycles);
+        return;
+    }
+    if (ksKernelEntry.path != Entry_Syscall &&
+            ksKernelEntry.path != Entry_UnknownSyscall) {
+        return;
+    }
+
+    latencyHistRecord(&latencyHistSyscall[ksKernelEntry.is_fastpath][syscall], cycles);
+
+    if (ksKernelEntry.is_fastpath ||
+            ksKernelEntry.invocation_tag >= nArchInvocationLabels) {
+        return;
+    }
+    switch (ksKernelEntry.cap_type) {
+    case cap_null_cap:
+    case cap_endpoint_cap:
+    case cap_notification_cap:
+    case cap_reply_cap:
+        /* not a kernel invocation, the label belongs to the user */
+        return;
+    default:
+        latencyHistRecord(&latencyHistInvocation[ksKernelEntry.invocation_tag], cycles);
+    }
+}
+
+exception_t
+latencyHistDump(word_t table, word_t index)
+{
+    word_t *ipcBuffer = lookupIPCBuffer(true, NODE_STATE(ksCurThread));
+    latency_hist_t *hist;
+    word_t *buffer;
+
+    if (ipcBuffer == NULL) {
+        userError("SysBenchmarkGetLatencyHistogram: no IPC buffer");
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    switch (table) {
+    case LATENCY_HIST_SLOWPATH:
+    case LATENCY_HIST_FASTPATH:
+        if (index >= LATENCY_HIST_SYSCALLS) {
+            userError("SysBenchmarkGetLatencyHistogram: invalid syscall %lu", index);
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+        hist = &latencyHistSyscall[table == LATENCY_HIST_FASTPATH][index];
+        break;
+    case LATENCY_HIST_INVOCATION:
+        if (index >= nArchInvocationLabels) {
+            userError("SysBenchmarkGetLatencyHistogram: invalid invocation label %lu", index);
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+        hist = &latencyHistInvocation[index];
+        break;
+    case LATENCY_HIST_FAULT_SLOWPATH:
+    case LATENCY_HIST_FAULT_FASTPATH:
+        if (index != 0) {
+            userError("SysBenchmarkGetLatencyHistogram: invalid fault index %lu", index);
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+        hist = &latencyHistFault[table == LATENCY_HIST_FAULT_FASTPATH];
+        break;
+    default:
+        userError("SysBenchmarkGetLatencyHistogram: invalid table %lu", table);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    buffer = &(((seL4_IPCBuffer *) ipcBuffer)->msg[0]);
+    buffer[LATENCY_HIST_COUNT] = hist->count;
+    buffer[LATENCY_HIST_MAX] = hist->max;
+    for (word_t i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        buffer[LATENCY_HIST_BUCKET + i] = hist->buckets[i];
+    }
+
+    return EXCEPTION_NONE;
+}
+
+void
+latencyHistReset(void)
+{
+    memzero(latencyHistSyscall, sizeof(latencyHistSyscall));
+    memzero(latencyHistInvocation, sizeof(latencyHistInvocation));
+    memzero(latencyHistFault, sizeof(latencyHistFault));
+}
+
+#endif /* CONFIG_BENCHMARK_LATENCY_HISTOGRAMS */
 #line 1 "/home/sandip/Desktop/test/seL/kernel/src/benchmark/benchmark_utilisation.c"
 /*
  * Copyright 2016, General Dynamics C4 Systems
@@ -3556,7 +4864,42 @@ void benchmark_track_reset_utilisation(void)
 #endif
 #include <benchmark/benchmark_utilisation.h>
 
-void
+#ifdef CONFIG_NTFN_USER_WORD
+void ntfnPublishUserWord(notification_t *ntfnPtr);
+#endif
+
+#ifdef CONFIG_EP_PRIORITY_QUEUES
+bool_t epIsPriorityOrdered(endpoint_t *epptr);
+#endif
+
+/* The fastpath reads tcbCTable, tcbVTable, tcbReply and tcbCaller out of
+ * the TCB CNode at the start of the TCB block; keep them on two lines. */
+compile_assert(fastpath_tcb_ctes_fit_two_lines,
+               (tcbCaller + 1) * sizeof(cte_t) <= 2 * L1_CACHE_LINE_SIZE)
+
+/* The other TCB fields fastpath_call and fastpath_reply_recv read sit
+ * together after the register file; keep them on three lines so a change
+ * to tcb_t cannot silently spread the fastpath over more of the TCB. */
+#define FASTPATH_TCB_FIRST_LINE(field) \
+    ((TCB_OFFSET + OFFSETOF(tcb_t, field)) / L1_CACHE_LINE_SIZE)
+#define FASTPATH_TCB_LAST_LINE(field) \
+    ((TCB_OFFSET + OFFSETOF(tcb_t, field) + sizeof(((tcb_t *) 0)->field) - 1) / L1_CACHE_LINE_SIZE)
+#define FASTPATH_TCB_LINES 3
+#define FASTPATH_TCB_FIELD(field) \
+    compile_assert(fastpath_tcb_##field##_on_hot_lines, \
+                   FASTPATH_TCB_FIRST_LINE(field) >= FASTPATH_TCB_FIRST_LINE(tcbState) && \
+                   FASTPATH_TCB_LAST_LINE(field) < FASTPATH_TCB_FIRST_LINE(tcbState) + FASTPATH_TCB_LINES)
+
+FASTPATH_TCB_FIELD(tcbState)
+FASTPATH_TCB_FIELD(tcbBoundNotification)
+FASTPATH_TCB_FIELD(tcbFault)
+FASTPATH_TCB_FIELD(tcbDomain)
+FASTPATH_TCB_FIELD(tcbPriority)
+FASTPATH_TCB_FIELD(tcbIPCBuffer)
+FASTPATH_TCB_FIELD(tcbEPNext)
+FASTPATH_TCB_FIELD(tcbEPPrev)
+
+SECTION(".text.hot") void
 #ifdef ARCH_X86
 NORETURN
 #endif
@@ -3609,6 +4952,13 @@ fastpath_call(word_t cptr, word_t msgInfo)
         slowpath(SysCall);
     }
 
+#ifdef CONFIG_EP_PRIORITY_QUEUES
+    /* The fastpath does not keep the queue in priority order */
+    if (unlikely(epIsPriorityOrdered(ep_ptr))) {
+        slowpath(SysCall);
+    }
+#endif
+
     /* ensure we are not single stepping the destination in ia32 */
 #if defined(CONFIG_HARDWARE_DEBUG_API) && defined(CONFIG_ARCH_IA32)
     if (dest->tcbArch.tcbContext.breakpointState.single_step_enabled) {
@@ -3685,7 +5035,7 @@ fastpath_call(word_t cptr, word_t msgInfo)
      * At this stage, we have committed to performing the IPC.
      */
 
-#ifdef CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES
+#if defined(CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES) || defined(CONFIG_BENCHMARK_LATENCY_HISTOGRAMS)
     ksKernelEntry.is_fastpath = true;
 #endif
 
@@ -3726,10 +5076,13 @@ fastpath_call(word_t cptr, word_t msgInfo)
 
     msgInfo = wordFromMessageInfo(seL4_MessageInfo_set_capsUnwrapped(info, 0));
 
+#ifdef CONFIG_BENCHMARK_LATENCY_HISTOGRAMS
+    latencyHistExit();
+#endif
     fastpath_restore(badge, msgInfo, NODE_STATE(ksCurThread));
 }
 
-void
+SECTION(".text.hot") void
 fastpath_reply_recv(word_t cptr, word_t msgInfo)
 {
     seL4_MessageInfo_t info;
@@ -3784,6 +5137,12 @@ fastpath_reply_recv(word_t cptr, word_t msgInfo)
         slowpath(SysReplyRecv);
     }
 
+#ifdef CONFIG_EP_PRIORITY_QUEUES
+    if (unlikely(epIsPriorityOrdered(ep_ptr))) {
+        slowpath(SysReplyRecv);
+    }
+#endif
+
     /* Only reply if the reply cap is valid. */
     callerSlot = TCB_PTR_CTE_PTR(NODE_STATE(ksCurThread), tcbCaller);
     callerCap = callerSlot->cap;
@@ -3804,9 +5163,17 @@ fastpath_reply_recv(word_t cptr, word_t msgInfo)
     /* Check that the caller has not faulted, in which case a fault
        reply is generated instead. */
     fault_type = seL4_Fault_get_seL4_FaultType(caller->tcbFault);
+#ifdef CONFIG_FASTPATH_VM_FAULT
+    /* except for VM faults, whose reply only restarts the caller */
+    if (unlikely(fault_type != seL4_Fault_NullFault &&
+                 fault_type != seL4_Fault_VMFault)) {
+        slowpath(SysReplyRecv);
+    }
+#else
     if (unlikely(fault_type != seL4_Fault_NullFault)) {
         slowpath(SysReplyRecv);
     }
+#endif
 
     /* Get destination thread.*/
     newVTable = TCB_PTR_CTE_PTR(caller, tcbVTable)->cap;
@@ -3849,78 +5216,314 @@ fastpath_reply_recv(word_t cptr, word_t msgInfo)
     }
 #endif
 
-    /* Ensure the original caller is in the current domain and can be scheduled directly. */
-    if (unlikely(caller->tcbDomain != ksCurDomain && maxDom)) {
-        slowpath(SysReplyRecv);
-    }
+    /* Ensure the original caller is in the current domain and can be scheduled directly. */
+    if (unlikely(caller->tcbDomain != ksCurDomain && maxDom)) {
+        slowpath(SysReplyRecv);
+    }
+
+#ifdef ENABLE_SMP_SUPPORT
+    /* Ensure both threads have the same affinity */
+    if (unlikely(NODE_STATE(ksCurThread)->tcbAffinity != caller->tcbAffinity)) {
+        slowpath(SysReplyRecv);
+    }
+#endif /* ENABLE_SMP_SUPPORT */
+
+    /*
+     * --- POINT OF NO RETURN ---
+     *
+     * At this stage, we have committed to performing the IPC.
+     */
+
+#if defined(CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES) || defined(CONFIG_BENCHMARK_LATENCY_HISTOGRAMS)
+    ksKernelEntry.is_fastpath = true;
+#endif
+
+    /* Set thread state to BlockedOnReceive */
+    thread_state_ptr_mset_blockingObject_tsType(
+        &NODE_STATE(ksCurThread)->tcbState, (word_t)ep_ptr, ThreadState_BlockedOnReceive);
+    thread_state_ptr_set_blockingIPCCanGrant(&NODE_STATE(ksCurThread)->tcbState,
+                                             cap_endpoint_cap_get_capCanGrant(ep_cap));;
+
+    /* Place the thread in the endpoint queue */
+    endpointTail = endpoint_ptr_get_epQueue_tail_fp(ep_ptr);
+    if (likely(!endpointTail)) {
+        NODE_STATE(ksCurThread)->tcbEPPrev = NULL;
+        NODE_STATE(ksCurThread)->tcbEPNext = NULL;
+
+        /* Set head/tail of queue and endpoint state. */
+        endpoint_ptr_set_epQueue_head_np(ep_ptr, TCB_REF(NODE_STATE(ksCurThread)));
+        endpoint_ptr_mset_epQueue_tail_state(ep_ptr, TCB_REF(NODE_STATE(ksCurThread)),
+                                             EPState_Recv);
+    } else {
+        /* Append current thread onto the queue. */
+        endpointTail->tcbEPNext = NODE_STATE(ksCurThread);
+        NODE_STATE(ksCurThread)->tcbEPPrev = endpointTail;
+        NODE_STATE(ksCurThread)->tcbEPNext = NULL;
+
+        /* Update tail of queue. */
+        endpoint_ptr_mset_epQueue_tail_state(ep_ptr, TCB_REF(NODE_STATE(ksCurThread)),
+                                             EPState_Recv);
+    }
+
+    /* Delete the reply cap. */
+    mdb_node_ptr_mset_mdbNext_mdbRevocable_mdbFirstBadged(
+        &CTE_PTR(mdb_node_get_mdbPrev(callerSlot->cteMDBNode))->cteMDBNode,
+        0, 1, 1);
+    callerSlot->cap = cap_null_cap_new();
+    callerSlot->cteMDBNode = nullMDBNode;
+
+#ifdef CONFIG_FASTPATH_VM_FAULT
+    if (unlikely(fault_type == seL4_Fault_VMFault)) {
+        /* As handleFaultReply: the message is ignored and the caller
+         * restarts at the faulting instruction with its own registers. */
+        caller->tcbFault = seL4_Fault_NullFault_new();
+        setNextPC(caller, getRestartPC(caller));
+        thread_state_ptr_set_tsType_np(&caller->tcbState,
+                                       ThreadState_Running);
+        switchToThread_fp(caller, cap_pd, stored_hw_asid);
+
+#ifdef CONFIG_BENCHMARK_LATENCY_HISTOGRAMS
+        latencyHistExit();
+#endif
+        fastpath_restore(getRegister(caller, capRegister),
+                         getRegister(caller, msgInfoRegister), caller);
+    }
+#endif /* CONFIG_FASTPATH_VM_FAULT */
+
+    /* I know there's no fault, so straight to the transfer. */
+
+    /* Replies don't have a badge. */
+    badge = 0;
+
+    fastpath_copy_mrs (length, NODE_STATE(ksCurThread), caller);
+
+    /* Dest thread is set Running, but not queued. */
+    thread_state_ptr_set_tsType_np(&caller->tcbState,
+                                   ThreadState_Running);
+    switchToThread_fp(caller, cap_pd, stored_hw_asid);
+
+    msgInfo = wordFromMessageInfo(seL4_MessageInfo_set_capsUnwrapped(info, 0));
+
+#ifdef CONFIG_BENCHMARK_LATENCY_HISTOGRAMS
+    latencyHistExit();
+#endif
+    fastpath_restore(badge, msgInfo, NODE_STATE(ksCurThread));
+}
+
+#ifdef CONFIG_FASTPATH_VM_FAULT
+/* Deliver a VM fault straight to a pager that is already waiting on the
+ * faulting thread's fault endpoint. This is sendFaultIPC and the fault
+ * transfer of doIPCTransfer, for the same cases that fastpath_call takes;
+ * anything else returns to c_handle_exception and goes the slow way. The
+ * pager's reply comes back through fastpath_reply_recv. */
+compile_assert(vm_fault_message_fits_registers, seL4_VMFault_Length <= n_msgRegisters)
+
+SECTION(".text.hot") void
+fastpath_vm_fault(word_t scause)
+{
+    cap_t ep_cap;
+    endpoint_t *ep_ptr;
+    tcb_t *dest;
+    word_t badge;
+    word_t length;
+    word_t msgInfo;
+    cte_t *replySlot, *callerSlot;
+    cap_t newVTable;
+    vspace_root_t *cap_pd;
+    pde_t stored_hw_asid;
+    dom_t dom;
+    word_t replyCanGrant;
+
+    /* Only the causes that handle_exception passes to handleVMFault */
+    switch (scause) {
+    case RISCVInstructionAccessFault:
+    case RISCVLoadAccessFault:
+    case RISCVStoreAccessFault:
+    case RISCVInstructionPageFault:
+    case RISCVLoadPageFault:
+    case RISCVStorePageFault:
+        break;
+    default:
+        return;
+    }
+
+    if (unlikely(seL4_Fault_get_seL4_FaultType(NODE_STATE(ksCurThread)->tcbFault) !=
+                 seL4_Fault_NullFault)) {
+        return;
+    }
+
+    /* Lookup the fault handler cap */
+    ep_cap = lookup_fp(TCB_PTR_CTE_PTR(NODE_STATE(ksCurThread), tcbCTable)->cap,
+                       NODE_STATE(ksCurThread)->tcbFaultHandler);
+
+    /* Check it's an endpoint that can carry a fault, as sendFaultIPC */
+    if (unlikely(!cap_capType_equals(ep_cap, cap_endpoint_cap) ||
+                 !cap_endpoint_cap_get_capCanSend(ep_cap) ||
+                 (!cap_endpoint_cap_get_capCanGrant(ep_cap) &&
+                  !cap_endpoint_cap_get_capCanGrantReply(ep_cap)))) {
+        return;
+    }
+
+    /* Get the endpoint address */
+    ep_ptr = EP_PTR(cap_endpoint_cap_get_capEPPtr(ep_cap));
+
+    /* Get the destination thread, which is only going to be valid
+     * if the endpoint is valid. */
+    dest = TCB_PTR(endpoint_ptr_get_epQueue_head(ep_ptr));
+
+    /* Check that there's a pager waiting to receive */
+    if (unlikely(endpoint_ptr_get_state(ep_ptr) != EPState_Recv)) {
+        return;
+    }
+
+#ifdef CONFIG_EP_PRIORITY_QUEUES
+    if (unlikely(epIsPriorityOrdered(ep_ptr))) {
+        return;
+    }
+#endif
+
+    /* Get destination thread.*/
+    newVTable = TCB_PTR_CTE_PTR(dest, tcbVTable)->cap;
+
+    /* Get vspace root. */
+    cap_pd = cap_vtable_cap_get_vspace_root_fp(newVTable);
+
+    /* Ensure that the destination has a valid VTable. */
+    if (unlikely(! isValidVTableRoot_fp(newVTable))) {
+        return;
+    }
+
+    /* Get HW ASID */
+    stored_hw_asid.words[0] = cap_page_table_cap_get_capPTMappedASID(newVTable);
+
+    /* let gcc optimise this out for 1 domain */
+    dom = maxDom ? ksCurDomain : 0;
+    /* ensure only the idle thread or lower prio threads are present in the scheduler */
+    if (likely(dest->tcbPriority < NODE_STATE(ksCurThread->tcbPriority)) &&
+            !isHighestPrio(dom, dest->tcbPriority)) {
+        return;
+    }
+
+    /* Ensure the pager is in the current domain and can be scheduled directly. */
+    if (unlikely(dest->tcbDomain != ksCurDomain && maxDom)) {
+        return;
+    }
+
+    /*
+     * --- POINT OF NO RETURN ---
+     *
+     * At this stage, we have committed to delivering the fault.
+     */
+
+#if defined(CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES) || defined(CONFIG_BENCHMARK_LATENCY_HISTOGRAMS)
+    ksKernelEntry.is_fastpath = true;
+#endif
+
+    /* Always reports a fault, which is recorded as sendFaultIPC would */
+    handleVMFault(NODE_STATE(ksCurThread), scause);
+    NODE_STATE(ksCurThread)->tcbFault = current_fault;
+
+    /* Dequeue the destination. */
+    endpoint_ptr_set_epQueue_head_np(ep_ptr, TCB_REF(dest->tcbEPNext));
+    if (unlikely(dest->tcbEPNext)) {
+        dest->tcbEPNext->tcbEPPrev = NULL;
+    } else {
+        endpoint_ptr_mset_epQueue_tail_state(ep_ptr, 0, EPState_Idle);
+    }
+
+    badge = cap_endpoint_cap_get_capEPBadge(ep_cap);
+
+    /* Block the faulting thread */
+    thread_state_ptr_set_tsType_np(&NODE_STATE(ksCurThread)->tcbState,
+                                   ThreadState_BlockedOnReply);
+
+    /* Get faulter reply slot */
+    replySlot = TCB_PTR_CTE_PTR(NODE_STATE(ksCurThread), tcbReply);
+
+    /* Get dest caller slot */
+    callerSlot = TCB_PTR_CTE_PTR(dest, tcbCaller);
+
+    /* Insert reply cap */
+    replyCanGrant = thread_state_ptr_get_blockingIPCCanGrant(&dest->tcbState);
+    cap_reply_cap_ptr_new_np(&callerSlot->cap, replyCanGrant, 0,
+                             TCB_REF(NODE_STATE(ksCurThread)));
+    mdb_node_ptr_set_mdbPrev_np(&callerSlot->cteMDBNode, CTE_REF(replySlot));
+    mdb_node_ptr_mset_mdbNext_mdbRevocable_mdbFirstBadged(
+        &replySlot->cteMDBNode, CTE_REF(callerSlot), 1, 1);
+
+    /* The VM fault message fits in registers, so no IPC buffer is needed */
+    length = Arch_setMRs_fault(NODE_STATE(ksCurThread), dest, NULL, seL4_Fault_VMFault);
 
-#ifdef ENABLE_SMP_SUPPORT
-    /* Ensure both threads have the same affinity */
-    if (unlikely(NODE_STATE(ksCurThread)->tcbAffinity != caller->tcbAffinity)) {
-        slowpath(SysReplyRecv);
-    }
-#endif /* ENABLE_SMP_SUPPORT */
+    /* Dest thread is set Running, but not queued. */
+    thread_state_ptr_set_tsType_np(&dest->tcbState,
+                                   ThreadState_Running);
+    switchToThread_fp(dest, cap_pd, stored_hw_asid);
 
-    /*
-     * --- POINT OF NO RETURN ---
-     *
-     * At this stage, we have committed to performing the IPC.
-     */
+    msgInfo = wordFromMessageInfo(seL4_MessageInfo_new(seL4_Fault_VMFault, 0, 0, length));
 
-#ifdef CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES
-    ksKernelEntry.is_fastpath = true;
+#ifdef CONFIG_BENCHMARK_LATENCY_HISTOGRAMS
+    latencyHistExit();
 #endif
+    fastpath_restore(badge, msgInfo, NODE_STATE(ksCurThread));
+}
+#endif /* CONFIG_FASTPATH_VM_FAULT */
 
-    /* Set thread state to BlockedOnReceive */
-    thread_state_ptr_mset_blockingObject_tsType(
-        &NODE_STATE(ksCurThread)->tcbState, (word_t)ep_ptr, ThreadState_BlockedOnReceive);
-    thread_state_ptr_set_blockingIPCCanGrant(&NODE_STATE(ksCurThread)->tcbState,
-                                             cap_endpoint_cap_get_capCanGrant(ep_cap));;
-
-    /* Place the thread in the endpoint queue */
-    endpointTail = endpoint_ptr_get_epQueue_tail_fp(ep_ptr);
-    if (likely(!endpointTail)) {
-        NODE_STATE(ksCurThread)->tcbEPPrev = NULL;
-        NODE_STATE(ksCurThread)->tcbEPNext = NULL;
+#ifdef CONFIG_IRQ_ACK_WAIT
+/* SysIRQAckWait when the interrupt has already been signalled: ack it and
+ * return the pending badge without blocking. When the caller would block
+ * it needs a scheduling decision, which is left to the slowpath. */
+SECTION(".text.hot") void
+fastpath_irq_ack_wait(word_t cptr, word_t msgInfo)
+{
+    cap_t irq_cap;
+    cap_t ntfn_cap;
+    notification_t *ntfn_ptr;
+    irq_t irq;
+    word_t badge;
 
-        /* Set head/tail of queue and endpoint state. */
-        endpoint_ptr_set_epQueue_head_np(ep_ptr, TCB_REF(NODE_STATE(ksCurThread)));
-        endpoint_ptr_mset_epQueue_tail_state(ep_ptr, TCB_REF(NODE_STATE(ksCurThread)),
-                                             EPState_Recv);
-    } else {
-        /* Append current thread onto the queue. */
-        endpointTail->tcbEPNext = NODE_STATE(ksCurThread);
-        NODE_STATE(ksCurThread)->tcbEPPrev = endpointTail;
-        NODE_STATE(ksCurThread)->tcbEPNext = NULL;
+    /* Lookup the cap */
+    irq_cap = lookup_fp(TCB_PTR_CTE_PTR(NODE_STATE(ksCurThread), tcbCTable)->cap, cptr);
 
-        /* Update tail of queue. */
-        endpoint_ptr_mset_epQueue_tail_state(ep_ptr, TCB_REF(NODE_STATE(ksCurThread)),
-                                             EPState_Recv);
+    /* Check it's an IRQ handler */
+    if (unlikely(!cap_capType_equals(irq_cap, cap_irq_handler_cap))) {
+        slowpath(SysIRQAckWait);
     }
 
-    /* Delete the reply cap. */
-    mdb_node_ptr_mset_mdbNext_mdbRevocable_mdbFirstBadged(
-        &CTE_PTR(mdb_node_get_mdbPrev(callerSlot->cteMDBNode))->cteMDBNode,
-        0, 1, 1);
-    callerSlot->cap = cap_null_cap_new();
-    callerSlot->cteMDBNode = nullMDBNode;
+    irq = cap_irq_handler_cap_get_capIRQ(irq_cap);
+    ntfn_cap = intStateIRQNode[irq].cap;
+    ntfn_ptr = NODE_STATE(ksCurThread)->tcbBoundNotification;
 
-    /* I know there's no fault, so straight to the transfer. */
+    /* Check the IRQ signals our bound notification, and that it is active */
+    if (unlikely(!cap_capType_equals(ntfn_cap, cap_notification_cap) ||
+                 ntfn_ptr == NULL ||
+                 NTFN_PTR(cap_notification_cap_get_capNtfnPtr(ntfn_cap)) != ntfn_ptr ||
+                 notification_ptr_get_state(ntfn_ptr) != NtfnState_Active)) {
+        slowpath(SysIRQAckWait);
+    }
 
-    /* Replies don't have a badge. */
-    badge = 0;
+    /*
+     * --- POINT OF NO RETURN ---
+     */
 
-    fastpath_copy_mrs (length, NODE_STATE(ksCurThread), caller);
+#if defined(CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES) || defined(CONFIG_BENCHMARK_LATENCY_HISTOGRAMS)
+    ksKernelEntry.is_fastpath = true;
+#endif
 
-    /* Dest thread is set Running, but not queued. */
-    thread_state_ptr_set_tsType_np(&caller->tcbState,
-                                   ThreadState_Running);
-    switchToThread_fp(caller, cap_pd, stored_hw_asid);
+    invokeIRQHandler_AckIRQ(irq);
 
-    msgInfo = wordFromMessageInfo(seL4_MessageInfo_set_capsUnwrapped(info, 0));
+    /* As receiveSignal on an active notification */
+    badge = notification_ptr_get_ntfnMsgIdentifier(ntfn_ptr);
+    notification_ptr_set_state(ntfn_ptr, NtfnState_Idle);
+#ifdef CONFIG_NTFN_USER_WORD
+    ntfnPublishUserWord(ntfn_ptr);
+#endif
 
+#ifdef CONFIG_BENCHMARK_LATENCY_HISTOGRAMS
+    latencyHistExit();
+#endif
     fastpath_restore(badge, msgInfo, NODE_STATE(ksCurThread));
 }
+#endif /* CONFIG_IRQ_ACK_WAIT */
 #line 1 "/home/sandip/Desktop/test/seL/kernel/src/inlines.c"
 /*
  * Copyright 2014, General Dynamics C4 Systems
@@ -4554,6 +6157,90 @@ bi_finalise(void)
 #include <model/statedata.h>
 #include <arch/machine.h>
 
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+
+/* A small direct-mapped cache of the slots lookupSlot() resolved. An entry
+ * is keyed on the whole CSpace root cap and the cptr, and is only valid in
+ * the epoch it was filled in. Resolution only depends on which slots hold
+ * CNode caps, so putting a CNode cap into a slot or taking one out moves on
+ * to a new epoch; other cap changes leave the cache alone. Only the slot is
+ * cached; its cap is always read afresh. */
+#define CAP_LOOKUP_CACHE_ENTRIES BIT(CONFIG_CAP_LOOKUP_CACHE_BITS)
+
+enum cap_lookup_cache_msg {
+    CAP_LOOKUP_CACHE_HITS,
+    CAP_LOOKUP_CACHE_MISSES,
+    CAP_LOOKUP_CACHE_INVALIDATIONS
+};
+
+typedef struct cap_lookup_cache_entry {
+    cap_t root;
+    cptr_t cptr;
+    word_t epoch;
+    cte_t *slot;
+} cap_lookup_cache_entry_t;
+
+static cap_lookup_cache_entry_t capLookupCache[CAP_LOOKUP_CACHE_ENTRIES];
+/* starts at 1 so that the zeroed entries are never valid */
+static word_t capLookupEpoch = 1;
+static word_t capLookupCacheHits;
+static word_t capLookupCacheMisses;
+static word_t capLookupCacheInvalidations;
+
+/* Called with each cap put into or taken out of a slot */
+void
+capLookupCacheInvalidate(cap_t cap)
+{
+    if (cap_get_capType(cap) == cap_cnode_cap) {
+        capLookupEpoch++;
+        capLookupCacheInvalidations++;
+    }
+}
+
+static inline cap_lookup_cache_entry_t *
+capLookupCacheEntry(cap_t root, cptr_t cptr)
+{
+    word_t key = cptr ^ root.words[0] ^ root.words[1];
+
+    key ^= key >> CONFIG_CAP_LOOKUP_CACHE_BITS;
+    return &capLookupCache[key & MASK(CONFIG_CAP_LOOKUP_CACHE_BITS)];
+}
+
+static inline bool_t
+capLookupCacheMatch(cap_lookup_cache_entry_t *entry, cap_t root, cptr_t cptr)
+{
+    return entry->epoch == capLookupEpoch && entry->cptr == cptr &&
+           entry->root.words[0] == root.words[0] &&
+           entry->root.words[1] == root.words[1];
+}
+
+exception_t
+capLookupCacheDump(bool_t reset)
+{
+    word_t *ipcBuffer = lookupIPCBuffer(true, NODE_STATE(ksCurThread));
+    word_t *buffer;
+
+    if (ipcBuffer == NULL) {
+        userError("SysBenchmarkGetCapLookupCacheStats: no IPC buffer");
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    buffer = &(((seL4_IPCBuffer *) ipcBuffer)->msg[0]);
+    buffer[CAP_LOOKUP_CACHE_HITS] = capLookupCacheHits;
+    buffer[CAP_LOOKUP_CACHE_MISSES] = capLookupCacheMisses;
+    buffer[CAP_LOOKUP_CACHE_INVALIDATIONS] = capLookupCacheInvalidations;
+
+    if (reset) {
+        capLookupCacheHits = 0;
+        capLookupCacheMisses = 0;
+        capLookupCacheInvalidations = 0;
+    }
+
+    return EXCEPTION_NONE;
+}
+
+#endif /* CONFIG_CAP_LOOKUP_CACHE */
+
 lookupCap_ret_t
 lookupCap(tcb_t *thread, cptr_t cPtr)
 {
@@ -4600,8 +6287,31 @@ lookupSlot(tcb_t *thread, cptr_t capptr)
     lookupSlot_raw_ret_t ret;
 
     threadRoot = TCB_PTR_CTE_PTR(thread, tcbCTable)->cap;
+
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+    cap_lookup_cache_entry_t *entry = capLookupCacheEntry(threadRoot, capptr);
+
+    if (likely(capLookupCacheMatch(entry, threadRoot, capptr))) {
+        capLookupCacheHits++;
+        ret.status = EXCEPTION_NONE;
+        ret.slot = entry->slot;
+        return ret;
+    }
+    capLookupCacheMisses++;
+#endif
+
     res_ret = resolveAddressBits(threadRoot, capptr, wordBits);
 
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+    /* failures are not cached, they have to set current_lookup_fault */
+    if (res_ret.status == EXCEPTION_NONE) {
+        entry->root = threadRoot;
+        entry->cptr = capptr;
+        entry->epoch = capLookupEpoch;
+        entry->slot = res_ret.slot;
+    }
+#endif
+
     ret.status = res_ret.status;
     ret.slot = res_ret.slot;
     return ret;
@@ -4910,8 +6620,14 @@ char kernel_stack_alloc[CONFIG_MAX_NUM_NODES][BIT(CONFIG_KERNEL_STACK_BITS)];
 #include <arch/machine.h>
 #include <arch/kernel/thread.h>
 #include <machine/registerset.h>
+#include <benchmark/benchmark.h>
+#include <benchmark/kernel_tracepoints.h>
 #include <linker.h>
 
+#ifdef CONFIG_EP_PRIORITY_QUEUES
+void epRequeueThread(tcb_t *tptr);
+#endif
+
 static seL4_MessageInfo_t
 transferCaps(seL4_MessageInfo_t info, extra_caps_t caps,
              endpoint_t *endpoint, tcb_t *receiver,
@@ -4940,7 +6656,7 @@ configureIdleThread(tcb_t *tcb)
     setThreadState(tcb, ThreadState_IdleThreadState);
 }
 
-void
+SECTION(".text.hot") void
 activateThread(void)
 {
     switch (thread_state_get_tsType(NODE_STATE(ksCurThread)->tcbState)) {
@@ -5164,9 +6880,10 @@ scheduleChooseNewThread(void)
     chooseThread();
 }
 
-void
+SECTION(".text.hot") void
 schedule(void)
 {
+    TRACE_POINT_START(TRACE_POINT_SCHEDULE);
     if (NODE_STATE(ksSchedulerAction) != SchedulerAction_ResumeCurrentThread) {
         bool_t was_runnable;
         if (isRunnable(NODE_STATE(ksCurThread))) {
@@ -5211,9 +6928,10 @@ schedule(void)
     doMaskReschedule(ARCH_NODE_STATE(ipiReschedulePending));
     ARCH_NODE_STATE(ipiReschedulePending) = 0;
 #endif /* ENABLE_SMP_SUPPORT */
+    TRACE_POINT_STOP(TRACE_POINT_SCHEDULE);
 }
 
-void
+SECTION(".text.hot") void
 chooseThread(void)
 {
     word_t prio;
@@ -5237,7 +6955,7 @@ chooseThread(void)
     }
 }
 
-void
+SECTION(".text.hot") void
 switchToThread(tcb_t *thread)
 {
 #ifdef CONFIG_BENCHMARK_TRACK_UTILISATION
@@ -5282,6 +7000,9 @@ setPriority(tcb_t *tptr, prio_t prio)
 {
     tcbSchedDequeue(tptr);
     tptr->tcbPriority = prio;
+#ifdef CONFIG_EP_PRIORITY_QUEUES
+    epRequeueThread(tptr);
+#endif
     if (isRunnable(tptr)) {
         SCHED_ENQUEUE(tptr);
         rescheduleRequired();
@@ -5452,10 +7173,126 @@ void fpuThreadDelete(tcb_t *thread)
 #include <config.h>
 #include <machine/io.h>
 
+#if defined(CONFIG_KERNEL_PRINT_BUFFER) && !defined(CONFIG_PRINTING)
+#error "CONFIG_KERNEL_PRINT_BUFFER depends on CONFIG_PRINTING"
+#endif
+
 #ifdef CONFIG_PRINTING
 
 #include <stdarg.h>
 
+#ifdef CONFIG_KERNEL_PRINT_BUFFER
+
+/* Kernel output is staged in a ring and drained to the console in bounded
+ * chunks on kernel exit and from the idle thread, rather than stalling the
+ * kernel for a console write per byte. The ring starts out in kernel memory
+ * and can be moved into a user frame with SysDebugSetPrintBuffer, which lets
+ * user level read the output back. The header at the start of the storage is
+ * only ever written by the kernel, all indices used here are kept in
+ * ksPrintBuffer so a user writing to the frame cannot corrupt them. */
+typedef struct print_buffer_header {
+    /* offset into the data following the header of the next byte written */
+    word_t head;
+    /* total bytes written, lets readers detect output they missed */
+    word_t written;
+} print_buffer_header_t;
+
+typedef struct print_buffer {
+    print_buffer_header_t *header;
+    char *data;
+    word_t size;
+    word_t head;
+    word_t tail;
+    word_t written;
+} print_buffer_t;
+
+static char ksPrintBufferBoot[BIT(CONFIG_KERNEL_PRINT_BUFFER_BITS)] ALIGN(sizeof(word_t));
+
+static print_buffer_t ksPrintBuffer = {
+    .header = (print_buffer_header_t *) ksPrintBufferBoot,
+    .data = ksPrintBufferBoot + sizeof(print_buffer_header_t),
+    .size = sizeof(ksPrintBufferBoot) - sizeof(print_buffer_header_t),
+};
+
+static inline word_t
+printBufferNext(word_t index)
+{
+    index++;
+    if (index == ksPrintBuffer.size) {
+        return 0;
+    }
+    return index;
+}
+
+bool_t
+printBufferPending(void)
+{
+    return ksPrintBuffer.head != ksPrintBuffer.tail;
+}
+
+void
+printBufferFlush(word_t max)
+{
+    while (max > 0 && printBufferPending()) {
+        putConsoleChar(ksPrintBuffer.data[ksPrintBuffer.tail]);
+        ksPrintBuffer.tail = printBufferNext(ksPrintBuffer.tail);
+        max--;
+    }
+}
+
+static void
+printBufferStore(char c)
+{
+    word_t next = printBufferNext(ksPrintBuffer.head);
+
+    if (next == ksPrintBuffer.tail) {
+        /* Full, make room synchronously rather than lose output */
+        printBufferFlush(CONFIG_KERNEL_PRINT_FLUSH_CHUNK);
+    }
+
+    ksPrintBuffer.data[ksPrintBuffer.head] = c;
+    ksPrintBuffer.head = next;
+    ksPrintBuffer.written++;
+    ksPrintBuffer.header->head = ksPrintBuffer.head;
+    ksPrintBuffer.header->written = ksPrintBuffer.written;
+}
+
+void
+printBufferSetStorage(void *base, word_t bytes)
+{
+    assert(bytes > sizeof(print_buffer_header_t));
+
+    /* Anything not yet on the console is written out before switching */
+    printBufferFlush(ksPrintBuffer.size);
+
+    ksPrintBuffer.header = base;
+    ksPrintBuffer.data = (char *) base + sizeof(print_buffer_header_t);
+    ksPrintBuffer.size = bytes - sizeof(print_buffer_header_t);
+    ksPrintBuffer.head = 0;
+    ksPrintBuffer.tail = 0;
+    ksPrintBuffer.header->head = 0;
+    ksPrintBuffer.header->written = ksPrintBuffer.written;
+}
+
+void
+printBufferRelease(void *base)
+{
+    if ((void *) ksPrintBuffer.header == base) {
+        printBufferSetStorage(ksPrintBufferBoot, sizeof(ksPrintBufferBoot));
+    }
+}
+
+void
+putchar(char c)
+{
+    printBufferStore(c);
+    if (c == '\n') {
+        printBufferStore('\r');
+    }
+}
+
+#else
+
 void
 putchar(char c)
 {
@@ -5465,6 +7302,8 @@ putchar(char c)
     }
 }
 
+#endif /* CONFIG_KERNEL_PRINT_BUFFER */
+
 static unsigned int
 print_spaces(int n)
 {
@@ -5882,12 +7721,12 @@ word_t ksNumCPUs;
 
 /* Pointer to the head of the scheduler queue for each priority */
 UP_STATE_DEFINE(tcb_queue_t, ksReadyQueues[NUM_READY_QUEUES]);
-UP_STATE_DEFINE(word_t, ksReadyQueuesL1Bitmap[CONFIG_NUM_DOMAINS]);
-UP_STATE_DEFINE(word_t, ksReadyQueuesL2Bitmap[CONFIG_NUM_DOMAINS][L2_BITMAP_SIZE]);
+UP_STATE_DEFINE(word_t, ksReadyQueuesL1Bitmap[CONFIG_NUM_DOMAINS] SECTION(".data.hot"));
+UP_STATE_DEFINE(word_t, ksReadyQueuesL2Bitmap[CONFIG_NUM_DOMAINS][L2_BITMAP_SIZE] SECTION(".data.hot"));
 compile_assert(ksReadyQueuesL1BitmapBigEnough, (L2_BITMAP_SIZE - 1) <= wordBits)
 
 /* Current thread TCB pointer */
-UP_STATE_DEFINE(tcb_t *, ksCurThread);
+UP_STATE_DEFINE(tcb_t *, ksCurThread SECTION(".data.hot"));
 
 /* Idle thread TCB pointer */
 UP_STATE_DEFINE(tcb_t *, ksIdleThread);
@@ -5895,7 +7734,7 @@ UP_STATE_DEFINE(tcb_t *, ksIdleThread);
 /* Values of 0 and ~0 encode ResumeCurrentThread and ChooseNewThread
  * respectively; other values encode SwitchToThread and must be valid
  * tcb pointers */
-UP_STATE_DEFINE(tcb_t *, ksSchedulerAction);
+UP_STATE_DEFINE(tcb_t *, ksSchedulerAction SECTION(".data.hot"));
 
 #ifdef CONFIG_HAVE_FPU
 /* Currently active FPU state, or NULL if there is no active FPU state */
@@ -5917,7 +7756,7 @@ irq_state_t intStateIRQTable[maxIRQ + 1];
 cte_t *intStateIRQNode;
 
 /* Currently active domain */
-dom_t ksCurDomain;
+dom_t ksCurDomain SECTION(".data.hot");
 
 /* Domain timeslice remaining */
 word_t ksDomainTime;
@@ -5928,7 +7767,8 @@ word_t ksDomScheduleIdx;
 /* Only used by lockTLBEntry */
 word_t tlbLockCount = 0;
 
-#if (defined CONFIG_DEBUG_BUILD || defined CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES)
+#if (defined CONFIG_DEBUG_BUILD || defined CONFIG_BENCHMARK_TRACK_KERNEL_ENTRIES || \
+     defined CONFIG_BENCHMARK_LATENCY_HISTOGRAMS)
 kernel_entry_t ksKernelEntry;
 #endif /* DEBUG */
 
@@ -5962,6 +7802,8 @@ paddr_t ksUserLogBuffer;
 #include <kernel/thread.h>
 #include <model/preemption.h>
 #include <model/statedata.h>
+#include <benchmark/benchmark.h>
+#include <benchmark/kernel_tracepoints.h>
 #include <util.h>
 
 struct finaliseSlot_ret {
@@ -5975,6 +7817,10 @@ static finaliseSlot_ret_t finaliseSlot(cte_t *slot, bool_t exposed);
 static void emptySlot(cte_t *slot, cap_t cleanupInfo);
 static exception_t reduceZombie(cte_t* slot, bool_t exposed);
 
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+void capLookupCacheInvalidate(cap_t cap);
+#endif
+
 exception_t
 decodeCNodeInvocation(word_t invLabel, word_t length, cap_t cap,
                       extra_caps_t excaps, word_t *buffer)
@@ -6250,7 +8096,13 @@ decodeCNodeInvocation(word_t invLabel, word_t length, cap_t cap,
 exception_t
 invokeCNodeRevoke(cte_t *destSlot)
 {
-    return cteRevoke(destSlot);
+    exception_t status;
+
+    TRACE_POINT_START(TRACE_POINT_CTE_REVOKE);
+    status = cteRevoke(destSlot);
+    TRACE_POINT_STOP(TRACE_POINT_CTE_REVOKE);
+
+    return status;
 }
 
 exception_t
@@ -6374,6 +8226,9 @@ cteInsert(cap_t newCap, cte_t *srcSlot, cte_t *destSlot)
      * untyped from it. */
     setUntypedCapAsFull(srcCap, newCap, srcSlot);
 
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+    capLookupCacheInvalidate(newCap);
+#endif
     destSlot->cap = newCap;
     destSlot->cteMDBNode = newMDB;
     mdb_node_ptr_set_mdbNext(&srcSlot->cteMDBNode, CTE_REF(destSlot));
@@ -6396,6 +8251,10 @@ cteMove(cap_t newCap, cte_t *srcSlot, cte_t *destSlot)
     assert((cte_t*)mdb_node_get_mdbNext(destSlot->cteMDBNode) == NULL &&
            (cte_t*)mdb_node_get_mdbPrev(destSlot->cteMDBNode) == NULL);
 
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+    capLookupCacheInvalidate(srcSlot->cap);
+    capLookupCacheInvalidate(newCap);
+#endif
     mdb = srcSlot->cteMDBNode;
     destSlot->cap = newCap;
     srcSlot->cap = cap_null_cap_new();
@@ -6436,6 +8295,10 @@ cteSwap(cap_t cap1, cte_t *slot1, cap_t cap2, cte_t *slot2)
     mdb_node_t mdb1, mdb2;
     word_t next_ptr, prev_ptr;
 
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+    capLookupCacheInvalidate(cap1);
+    capLookupCacheInvalidate(cap2);
+#endif
     slot1->cap = cap2;
     slot2->cap = cap1;
 
@@ -6532,6 +8395,9 @@ emptySlot(cte_t *slot, cap_t cleanupInfo)
             mdb_node_ptr_set_mdbFirstBadged(&next->cteMDBNode,
                                             mdb_node_get_mdbFirstBadged(next->cteMDBNode) ||
                                             mdb_node_get_mdbFirstBadged(mdbNode));
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+        capLookupCacheInvalidate(slot->cap);
+#endif
         slot->cap = cap_null_cap_new();
         slot->cteMDBNode = nullMDBNode;
 
@@ -6581,6 +8447,9 @@ finaliseSlot(cte_t *slot, bool_t immediate)
             return ret;
         }
 
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+        capLookupCacheInvalidate(slot->cap);
+#endif
         slot->cap = fc_ret.remainder;
 
         if (!immediate && capCyclicZombie(fc_ret.remainder, slot)) {
@@ -6701,6 +8570,9 @@ insertNewCap(cte_t *parent, cte_t *slot, cap_t cap)
     cte_t *next;
 
     next = CTE_PTR(mdb_node_get_mdbNext(parent->cteMDBNode));
+#ifdef CONFIG_CAP_LOOKUP_CACHE
+    capLookupCacheInvalidate(cap);
+#endif
     slot->cap = cap;
     slot->cteMDBNode = mdb_node_new(CTE_REF(next), true, true, CTE_REF(parent));
     if (next) {
@@ -6925,6 +8797,147 @@ ep_ptr_set_queue(endpoint_t *epptr, tcb_queue_t queue)
     endpoint_ptr_set_epQueue_tail(epptr, (word_t)queue.end);
 }
 
+#ifdef CONFIG_EP_BADGE_INDEX
+/* Number of threads blocked sending with each (endpoint, badge) pair,
+ * hashed into a fixed table shared by all endpoints. Pairs can share a
+ * bucket, so a count is only an upper bound on the senders with any one
+ * badge. A count of zero lets cancelBadgedSends skip the queue; anything
+ * else still costs a full scan. */
+static word_t epBadgeSenders[BIT(CONFIG_EP_BADGE_INDEX_BITS)];
+
+static inline word_t *
+epBadgeSendersFor(endpoint_t *epptr, word_t badge)
+{
+    word_t key = (EP_REF(epptr) >> seL4_EndpointBits) ^ badge;
+
+    key ^= key >> CONFIG_EP_BADGE_INDEX_BITS;
+    return &epBadgeSenders[key & MASK(CONFIG_EP_BADGE_INDEX_BITS)];
+}
+#endif /* CONFIG_EP_BADGE_INDEX */
+
+#ifdef CONFIG_EP_PRIORITY_QUEUES
+/* Endpoints retyped with RETYPE_FLAG_EP_PRIORITY_ORDERED. The endpoint
+ * object has no field for the flag, so it is kept here instead. The count
+ * lets the usual case, no such endpoint at all, skip the search. */
+static endpoint_t *epPriorityOrdered[CONFIG_EP_PRIORITY_QUEUE_SLOTS];
+static word_t epPriorityOrderedCount;
+
+bool_t
+epIsPriorityOrdered(endpoint_t *epptr)
+{
+    word_t i;
+
+    if (likely(epPriorityOrderedCount == 0)) {
+        return false;
+    }
+    for (i = 0; i < CONFIG_EP_PRIORITY_QUEUE_SLOTS; i++) {
+        if (epPriorityOrdered[i] == epptr) {
+            return true;
+        }
+    }
+    return false;
+}
+
+word_t
+epPriorityOrderedSlotsFree(void)
+{
+    return CONFIG_EP_PRIORITY_QUEUE_SLOTS - epPriorityOrderedCount;
+}
+
+/* The caller has checked that a slot is free */
+void
+epSetPriorityOrdered(endpoint_t *epptr)
+{
+    word_t i;
+
+    for (i = 0; i < CONFIG_EP_PRIORITY_QUEUE_SLOTS; i++) {
+        if (epPriorityOrdered[i] == NULL) {
+            epPriorityOrdered[i] = epptr;
+            epPriorityOrderedCount++;
+            return;
+        }
+    }
+    fail("No free priority ordered endpoint slot");
+}
+
+/* Called when the last cap to an endpoint goes away */
+void
+epReleasePriorityOrdered(endpoint_t *epptr)
+{
+    word_t i;
+
+    if (likely(epPriorityOrderedCount == 0)) {
+        return;
+    }
+    for (i = 0; i < CONFIG_EP_PRIORITY_QUEUE_SLOTS; i++) {
+        if (epPriorityOrdered[i] == epptr) {
+            epPriorityOrdered[i] = NULL;
+            epPriorityOrderedCount--;
+            return;
+        }
+    }
+}
+
+/* Queue a thread behind every thread of the same or higher priority, so
+ * that the head of a priority ordered endpoint is always its most urgent
+ * thread and threads of equal priority stay in FIFO order. A thread no more
+ * urgent than the tail is appended straight away, which is the usual case
+ * for bulk clients; otherwise the walk from the head only passes over the
+ * threads that are at least as urgent as it is. */
+static tcb_queue_t
+ep_queue_insert(endpoint_t *epptr, tcb_t *tcb, tcb_queue_t queue)
+{
+    tcb_t *before;
+
+    if (!epIsPriorityOrdered(epptr) || !queue.head ||
+            queue.end->tcbPriority >= tcb->tcbPriority) {
+        return tcbEPAppend(tcb, queue);
+    }
+
+    /* Stops before running off the end as the tail is less urgent */
+    for (before = queue.head; before->tcbPriority >= tcb->tcbPriority;
+            before = before->tcbEPNext);
+
+    tcb->tcbEPNext = before;
+    tcb->tcbEPPrev = before->tcbEPPrev;
+    if (before->tcbEPPrev) {
+        before->tcbEPPrev->tcbEPNext = tcb;
+    } else {
+        queue.head = tcb;
+    }
+    before->tcbEPPrev = tcb;
+
+    return queue;
+}
+
+/* Move a thread blocked on a priority ordered endpoint to the place its
+ * new priority gives it */
+void
+epRequeueThread(tcb_t *tptr)
+{
+    endpoint_t *epptr;
+    tcb_queue_t queue;
+
+    switch (thread_state_ptr_get_tsType(&tptr->tcbState)) {
+    case ThreadState_BlockedOnSend:
+    case ThreadState_BlockedOnReceive:
+        epptr = EP_PTR(thread_state_ptr_get_blockingObject(&tptr->tcbState));
+        if (!epIsPriorityOrdered(epptr)) {
+            break;
+        }
+
+        queue = ep_ptr_get_queue(epptr);
+        queue = tcbEPDequeue(tptr, queue);
+        queue = ep_queue_insert(epptr, tptr, queue);
+        ep_ptr_set_queue(epptr, queue);
+        break;
+
+    default:
+        break;
+    }
+}
+#endif /* CONFIG_EP_PRIORITY_QUEUES */
+
 void
 sendIPC(bool_t blocking, bool_t do_call, word_t badge,
         bool_t canGrant, bool_t canGrantReply, tcb_t *thread, endpoint_t *epptr)
@@ -6953,9 +8966,16 @@ sendIPC(bool_t blocking, bool_t do_call, word_t badge,
 
             /* Place calling thread in endpoint queue */
             queue = ep_ptr_get_queue(epptr);
+#ifdef CONFIG_EP_PRIORITY_QUEUES
+            queue = ep_queue_insert(epptr, thread, queue);
+#else
             queue = tcbEPAppend(thread, queue);
+#endif
             endpoint_ptr_set_state(epptr, EPState_Send);
             ep_ptr_set_queue(epptr, queue);
+#ifdef CONFIG_EP_BADGE_INDEX
+            (*epBadgeSendersFor(epptr, badge))++;
+#endif
         }
         break;
 
@@ -7034,7 +9054,11 @@ receiveIPC(tcb_t *thread, cap_t cap, bool_t isBlocking)
 
                 /* Place calling thread in endpoint queue */
                 queue = ep_ptr_get_queue(epptr);
+#ifdef CONFIG_EP_PRIORITY_QUEUES
+                queue = ep_queue_insert(epptr, thread, queue);
+#else
                 queue = tcbEPAppend(thread, queue);
+#endif
                 endpoint_ptr_set_state(epptr, EPState_Recv);
                 ep_ptr_set_queue(epptr, queue);
             } else {
@@ -7068,6 +9092,9 @@ receiveIPC(tcb_t *thread, cap_t cap, bool_t isBlocking)
 
             /* Get sender IPC details */
             badge = thread_state_ptr_get_blockingIPCBadge(&sender->tcbState);
+#ifdef CONFIG_EP_BADGE_INDEX
+            (*epBadgeSendersFor(epptr, badge))--;
+#endif
             canGrant =
                 thread_state_ptr_get_blockingIPCCanGrant(&sender->tcbState);
             canGrantReply =
@@ -7143,6 +9170,12 @@ cancelIPC(tcb_t *tptr)
             endpoint_ptr_set_state(epptr, EPState_Idle);
         }
 
+#ifdef CONFIG_EP_BADGE_INDEX
+        if (thread_state_ptr_get_tsType(state) == ThreadState_BlockedOnSend) {
+            (*epBadgeSendersFor(epptr, thread_state_ptr_get_blockingIPCBadge(state)))--;
+        }
+#endif
+
         setThreadState(tptr, ThreadState_Inactive);
         break;
     }
@@ -7181,6 +9214,9 @@ cancelAllIPC(endpoint_t *epptr)
 
     default: {
         tcb_t *thread = TCB_PTR(endpoint_ptr_get_epQueue_head(epptr));
+#ifdef CONFIG_EP_BADGE_INDEX
+        bool_t senders = endpoint_ptr_get_state(epptr) == EPState_Send;
+#endif
 
         /* Make endpoint idle */
         endpoint_ptr_set_state(epptr, EPState_Idle);
@@ -7189,6 +9225,12 @@ cancelAllIPC(endpoint_t *epptr)
 
         /* Set all blocked threads to restart */
         for (; thread; thread = thread->tcbEPNext) {
+#ifdef CONFIG_EP_BADGE_INDEX
+            if (senders) {
+                (*epBadgeSendersFor(epptr,
+                                    thread_state_ptr_get_blockingIPCBadge(&thread->tcbState)))--;
+            }
+#endif
             setThreadState (thread, ThreadState_Restart);
             SCHED_ENQUEUE(thread);
         }
@@ -7210,6 +9252,14 @@ cancelBadgedSends(endpoint_t *epptr, word_t badge)
     case EPState_Send: {
         tcb_t *thread, *next;
         tcb_queue_t queue = ep_ptr_get_queue(epptr);
+#ifdef CONFIG_EP_BADGE_INDEX
+        word_t *senders = epBadgeSendersFor(epptr, badge);
+
+        if (*senders == 0) {
+            /* nobody can be queued with this badge */
+            break;
+        }
+#endif
 
         /* this is a de-optimisation for verification
          * reasons. it allows the contents of the endpoint
@@ -7226,6 +9276,9 @@ cancelBadgedSends(endpoint_t *epptr, word_t badge)
                 setThreadState(thread, ThreadState_Restart);
                 SCHED_ENQUEUE(thread);
                 queue = tcbEPDequeue(thread, queue);
+#ifdef CONFIG_EP_BADGE_INDEX
+                (*senders)--;
+#endif
             }
         }
         ep_ptr_set_queue(epptr, queue);
@@ -7271,6 +9324,321 @@ cancelBadgedSends(endpoint_t *epptr, word_t badge)
 #include <plat/machine/timer.h>
 #include <smp/ipi.h>
 
+#ifdef CONFIG_IRQ_STATISTICS
+
+/* Per-IRQ delivery counters, plus a log2 histogram of the cycles from the
+ * kernel taking an interrupt to the thread that the signal woke returning
+ * to user level. Only one latency sample per IRQ is in flight at a time;
+ * if the IRQ fires again before its waiter runs, the older sample is
+ * replaced. */
+#define IRQ_LATENCY_BUCKETS 32
+
+enum irq_stats_msg {
+    IRQ_STATS_DELIVERED,
+    IRQ_STATS_UNDELIVERED,
+    IRQ_STATS_MASKED,
+    IRQ_STATS_SPURIOUS,
+    IRQ_STATS_MAX_LATENCY,
+    IRQ_STATS_LATENCY,
+    IRQ_STATS_MSG_LENGTH = IRQ_STATS_LATENCY + IRQ_LATENCY_BUCKETS
+};
+
+typedef struct irq_stats {
+    word_t delivered;
+    word_t undelivered;
+    /* fired while disabled, or again before the handler acked it */
+    word_t masked;
+    bool_t awaitingAck;
+    tcb_t *waiter;
+    word_t start;
+    word_t maxLatency;
+    word_t latency[IRQ_LATENCY_BUCKETS];
+} irq_stats_t;
+
+compile_assert(irq_stats_pending_fits_word, maxIRQ < wordBits)
+compile_assert(irq_stats_fit_in_ipc_buffer, IRQ_STATS_MSG_LENGTH <= seL4_MsgMaxLength)
+
+static irq_stats_t irqStats[maxIRQ + 1];
+static word_t irqStatsSpurious;
+static word_t irqStatsEntryTime;
+/* bitmap of IRQs whose waiter has not returned to user level yet */
+static word_t irqStatsPending;
+
+static inline word_t
+irqStatsTimestamp(void)
+{
+    word_t cycles;
+    asm volatile("rdcycle %0" : "=r"(cycles));
+    return cycles;
+}
+
+/* The thread sendSignal() is about to wake, if any */
+static tcb_t *
+irqStatsWaiter(notification_t *ntfnPtr)
+{
+    tcb_t *tcb;
+
+    switch (notification_ptr_get_state(ntfnPtr)) {
+    case NtfnState_Waiting:
+        return TCB_PTR(notification_ptr_get_ntfnQueue_head(ntfnPtr));
+
+    case NtfnState_Idle:
+        tcb = TCB_PTR(notification_ptr_get_ntfnBoundTCB(ntfnPtr));
+        if (tcb && thread_state_ptr_get_tsType(&tcb->tcbState) == ThreadState_BlockedOnReceive) {
+            return tcb;
+        }
+        return NULL;
+
+    default:
+        return NULL;
+    }
+}
+
+static void
+irqStatsDelivered(irq_t irq, notification_t *ntfnPtr)
+{
+    irq_stats_t *stats = &irqStats[irq];
+
+    stats->delivered++;
+    if (stats->awaitingAck) {
+        stats->masked++;
+    }
+    stats->awaitingAck = true;
+
+    stats->waiter = irqStatsWaiter(ntfnPtr);
+    if (stats->waiter) {
+        stats->start = irqStatsEntryTime;
+        irqStatsPending |= BIT(irq);
+    } else {
+        irqStatsPending &= ~BIT(irq);
+    }
+}
+
+void
+irqStatsEntry(void)
+{
+    irqStatsEntryTime = irqStatsTimestamp();
+}
+
+void
+irqStatsExit(void)
+{
+    word_t pending = irqStatsPending;
+
+    while (pending) {
+        irq_t irq = wordBits - 1 - clzl(pending);
+        irq_stats_t *stats = &irqStats[irq];
+
+        pending &= ~BIT(irq);
+        if (stats->waiter == NODE_STATE(ksCurThread)) {
+            word_t latency = irqStatsTimestamp() - stats->start;
+            word_t bucket = latency ? wordBits - clzl(latency) : 0;
+
+            if (bucket >= IRQ_LATENCY_BUCKETS) {
+                bucket = IRQ_LATENCY_BUCKETS - 1;
+            }
+            stats->latency[bucket]++;
+            if (latency > stats->maxLatency) {
+                stats->maxLatency = latency;
+            }
+            stats->waiter = NULL;
+            irqStatsPending &= ~BIT(irq);
+        }
+    }
+}
+
+void
+irqStatsSpuriousIRQ(void)
+{
+    irqStatsSpurious++;
+}
+
+exception_t
+irqStatsDump(void)
+{
+    word_t irq = getRegister(NODE_STATE(ksCurThread), capRegister);
+    word_t *ipcBuffer = lookupIPCBuffer(true, NODE_STATE(ksCurThread));
+    word_t *buffer;
+
+    if (irq > maxIRQ || ipcBuffer == NULL) {
+        userError("SysDebugGetIRQStatistics: invalid IRQ %lu or no IPC buffer", irq);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    buffer = &(((seL4_IPCBuffer *) ipcBuffer)->msg[0]);
+    buffer[IRQ_STATS_DELIVERED] = irqStats[irq].delivered;
+    buffer[IRQ_STATS_UNDELIVERED] = irqStats[irq].undelivered;
+    buffer[IRQ_STATS_MASKED] = irqStats[irq].masked;
+    buffer[IRQ_STATS_SPURIOUS] = irqStatsSpurious;
+    buffer[IRQ_STATS_MAX_LATENCY] = irqStats[irq].maxLatency;
+    for (word_t i = 0; i < IRQ_LATENCY_BUCKETS; i++) {
+        buffer[IRQ_STATS_LATENCY + i] = irqStats[irq].latency[i];
+    }
+
+    return EXCEPTION_NONE;
+}
+
+void
+irqStatsReset(void)
+{
+    for (word_t i = 0; i <= maxIRQ; i++) {
+        bool_t awaitingAck = irqStats[i].awaitingAck;
+
+        memzero(&irqStats[i], sizeof(irq_stats_t));
+        irqStats[i].awaitingAck = awaitingAck;
+    }
+    irqStatsSpurious = 0;
+    irqStatsPending = 0;
+}
+
+#endif /* CONFIG_IRQ_STATISTICS */
+
+#ifdef CONFIG_PROFILER_SAMPLING
+
+/* Statistical PC sampling. Every CONFIG_PROFILER_SAMPLE_INTERVAL timer ticks
+ * the thread that the tick interrupted is recorded into a ring. When the
+ * ring becomes half full the registered notification is signalled, and the
+ * profiler thread drains it with SysDebugGetProfilerSamples. The thread is
+ * identified by its TCB address, matching the capDL dump. */
+#define PROFILER_SAMPLES BIT(CONFIG_PROFILER_SAMPLE_BITS)
+
+enum profiler_sample_flags {
+    /* the tick arrived at a preemption point of a long running syscall */
+    PROFILER_SAMPLE_IN_KERNEL = BIT(0),
+    PROFILER_SAMPLE_IDLE = BIT(1)
+};
+
+typedef struct profiler_sample {
+    word_t thread;
+    word_t pc;
+    word_t ra;
+    word_t flags;
+} profiler_sample_t;
+
+#define PROFILER_SAMPLE_WORDS (sizeof(profiler_sample_t) / sizeof(word_t))
+/* msg[0] holds the number of samples dropped since the last drain */
+#define PROFILER_SAMPLES_PER_DRAIN ((seL4_MsgMaxLength - 1) / PROFILER_SAMPLE_WORDS)
+
+/* The ring always has a power of two entries; the drain is signalled when
+ * it is half full, which has to be at least one sample */
+compile_assert(profiler_half_ring_nonzero, CONFIG_PROFILER_SAMPLE_BITS > 1)
+
+bool_t profilerFromTrap;
+static profiler_sample_t profilerSamples[PROFILER_SAMPLES];
+/* free running; the ring index is the count modulo PROFILER_SAMPLES */
+static word_t profilerHead;
+static word_t profilerTail;
+static word_t profilerDropped;
+static word_t profilerTicks;
+static notification_t *profilerNtfn;
+static word_t profilerBadge;
+
+static void
+profilerSample(void)
+{
+    tcb_t *thread = NODE_STATE(ksCurThread);
+    profiler_sample_t *sample;
+    word_t used;
+
+    if (++profilerTicks < CONFIG_PROFILER_SAMPLE_INTERVAL) {
+        return;
+    }
+    profilerTicks = 0;
+
+    used = profilerHead - profilerTail;
+    if (used == PROFILER_SAMPLES) {
+        profilerDropped++;
+        return;
+    }
+
+    sample = &profilerSamples[profilerHead & MASK(CONFIG_PROFILER_SAMPLE_BITS)];
+    sample->thread = (word_t) thread;
+    sample->pc = getRestartPC(thread);
+    sample->ra = getRegister(thread, ra);
+    sample->flags = 0;
+    if (!profilerFromTrap) {
+        sample->flags |= PROFILER_SAMPLE_IN_KERNEL;
+    }
+    if (thread == NODE_STATE(ksIdleThread)) {
+        sample->flags |= PROFILER_SAMPLE_IDLE;
+    }
+    profilerHead++;
+
+    /* signal once per fill rather than on every tick */
+    if (used + 1 == PROFILER_SAMPLES / 2 && profilerNtfn != NULL) {
+        sendSignal(profilerNtfn, profilerBadge);
+    }
+}
+
+exception_t
+profilerSetNotification(word_t ntfn_cptr)
+{
+    lookupCap_ret_t lu_ret;
+
+    lu_ret = lookupCap(NODE_STATE(ksCurThread), ntfn_cptr);
+    if (unlikely(lu_ret.status != EXCEPTION_NONE)) {
+        userError("SysDebugSetProfilerNotification: invalid cap #%lu.", ntfn_cptr);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    /* a null cap turns signalling off; sampling itself always runs */
+    if (cap_get_capType(lu_ret.cap) == cap_null_cap) {
+        profilerNtfn = NULL;
+        return EXCEPTION_NONE;
+    }
+
+    if (cap_get_capType(lu_ret.cap) != cap_notification_cap ||
+            !cap_notification_cap_get_capNtfnCanSend(lu_ret.cap)) {
+        userError("SysDebugSetProfilerNotification: cap #%lu is not a sendable notification.", ntfn_cptr);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    profilerNtfn = NTFN_PTR(cap_notification_cap_get_capNtfnPtr(lu_ret.cap));
+    profilerBadge = cap_notification_cap_get_capNtfnBadge(lu_ret.cap);
+    return EXCEPTION_NONE;
+}
+
+/* Called when the last cap to a notification goes away */
+void
+profilerReleaseNotification(notification_t *ntfnPtr)
+{
+    if (profilerNtfn == ntfnPtr) {
+        profilerNtfn = NULL;
+    }
+}
+
+word_t
+profilerDrain(void)
+{
+    word_t *ipcBuffer = lookupIPCBuffer(true, NODE_STATE(ksCurThread));
+    word_t *buffer;
+    word_t count = 0;
+
+    if (ipcBuffer == NULL) {
+        return 0;
+    }
+
+    buffer = &(((seL4_IPCBuffer *) ipcBuffer)->msg[0]);
+    buffer[0] = profilerDropped;
+    profilerDropped = 0;
+
+    while (profilerTail != profilerHead && count < PROFILER_SAMPLES_PER_DRAIN) {
+        profiler_sample_t *sample = &profilerSamples[profilerTail & MASK(CONFIG_PROFILER_SAMPLE_BITS)];
+        word_t *dest = &buffer[1 + count * PROFILER_SAMPLE_WORDS];
+
+        dest[0] = sample->thread;
+        dest[1] = sample->pc;
+        dest[2] = sample->ra;
+        dest[3] = sample->flags;
+        profilerTail++;
+        count++;
+    }
+
+    return count;
+}
+
+#endif /* CONFIG_PROFILER_SAMPLING */
+
 exception_t
 decodeIRQControlInvocation(word_t invLabel, word_t length,
                            cte_t *srcSlot, extra_caps_t excaps,
@@ -7390,6 +9758,9 @@ decodeIRQHandlerInvocation(word_t invLabel, irq_t irq,
 void
 invokeIRQHandler_AckIRQ(irq_t irq)
 {
+#ifdef CONFIG_IRQ_STATISTICS
+    irqStats[irq].awaitingAck = false;
+#endif
     maskInterrupt(false, irq);
 }
 
@@ -7430,7 +9801,7 @@ deletedIRQHandler(irq_t irq)
     setIRQState(IRQInactive, irq);
 }
 
-void
+SECTION(".text.hot") void
 handleInterrupt(irq_t irq)
 {
     if (unlikely(irq > maxIRQ)) {
@@ -7439,6 +9810,9 @@ handleInterrupt(irq_t irq)
          * it is safe to use in mask and ack operations, even though it is
          * above the claimed maxIRQ. i.e. we're assuming maxIRQ is wrong */
         printf("Received IRQ %d, which is above the platforms maxIRQ of %d\n", (int)irq, (int)maxIRQ);
+#ifdef CONFIG_IRQ_STATISTICS
+        irqStatsSpuriousIRQ();
+#endif
         maskInterrupt(true, irq);
         ackInterrupt(irq);
         return;
@@ -7451,9 +9825,15 @@ handleInterrupt(irq_t irq)
 
         if (cap_get_capType(cap) == cap_notification_cap &&
                 cap_notification_cap_get_capNtfnCanSend(cap)) {
+#ifdef CONFIG_IRQ_STATISTICS
+            irqStatsDelivered(irq, NTFN_PTR(cap_notification_cap_get_capNtfnPtr(cap)));
+#endif
             sendSignal(NTFN_PTR(cap_notification_cap_get_capNtfnPtr(cap)),
                        cap_notification_cap_get_capNtfnBadge(cap));
         } else {
+#ifdef CONFIG_IRQ_STATISTICS
+            irqStats[irq].undelivered++;
+#endif
 #ifdef CONFIG_IRQ_REPORTING
             printf("Undelivered IRQ: %d\n", (int)irq);
 #endif
@@ -7463,6 +9843,9 @@ handleInterrupt(irq_t irq)
     }
 
     case IRQTimer:
+#ifdef CONFIG_PROFILER_SAMPLING
+        profilerSample();
+#endif
         timerTick();
         resetTimer();
         break;
@@ -7487,6 +9870,9 @@ handleInterrupt(irq_t irq)
          * the interrupt go away.
          */
         maskInterrupt(true, irq);
+#ifdef CONFIG_IRQ_STATISTICS
+        irqStats[irq].masked++;
+#endif
 #ifdef CONFIG_IRQ_REPORTING
         printf("Received disabled IRQ: %d\n", (int)irq);
 #endif
@@ -7523,17 +9909,243 @@ setIRQState(irq_state_t irqState, irq_t irq)
  * @TAG(GD_GPL)
  */
 
-#include <assert.h>
+#include <assert.h>
+
+#include <types.h>
+#include <kernel/thread.h>
+#include <object/structures.h>
+#include <object/tcb.h>
+#include <object/endpoint.h>
+#include <model/statedata.h>
+#include <machine/io.h>
+
+#include <object/notification.h>
+
+#ifdef CONFIG_NTFN_USER_WORD
+#include <kernel/cspace.h>
+#include <kernel/vspace.h>
+
+/* A notification can publish whether it has a signal pending into a frame
+ * that its receivers map read-only, so that an empty poll is a load rather
+ * than a trap. The kernel rewrites the view whenever the notification
+ * becomes active or idle; the badge is only meaningful while pending is
+ * set, and a poll or wait is still needed to consume the signal.
+ *
+ * The index of the notification's entry in ntfnUserWords, plus one, is
+ * kept in bits 2-15 of its first word, between state and ntfnQueue_tail,
+ * which the generated setters leave alone. Zero means not published. */
+#define NTFN_USER_WORD_SHIFT 2
+#define NTFN_USER_WORD_BITS 14
+
+compile_assert(ntfn_user_word_slots_fit,
+               CONFIG_NTFN_USER_WORD_SLOTS < BIT(NTFN_USER_WORD_BITS))
+
+typedef struct ntfn_user_view {
+    word_t pending;
+    word_t badge;
+} ntfn_user_view_t;
+
+typedef struct ntfn_user_word {
+    notification_t *ntfn;
+    ntfn_user_view_t *view;
+} ntfn_user_word_t;
+
+static ntfn_user_word_t ntfnUserWords[CONFIG_NTFN_USER_WORD_SLOTS];
+
+static inline word_t PURE
+notification_ptr_get_ntfnUserWord(notification_t *ntfnPtr)
+{
+    return (ntfnPtr->words[0] >> NTFN_USER_WORD_SHIFT) & MASK(NTFN_USER_WORD_BITS);
+}
+
+static inline void
+notification_ptr_set_ntfnUserWord(notification_t *ntfnPtr, word_t v)
+{
+    ntfnPtr->words[0] &= ~(MASK(NTFN_USER_WORD_BITS) << NTFN_USER_WORD_SHIFT);
+    ntfnPtr->words[0] |= (v & MASK(NTFN_USER_WORD_BITS)) << NTFN_USER_WORD_SHIFT;
+}
+
+void
+ntfnPublishUserWord(notification_t *ntfnPtr)
+{
+    word_t index = notification_ptr_get_ntfnUserWord(ntfnPtr);
+    ntfn_user_view_t *view;
+
+    if (likely(index == 0)) {
+        return;
+    }
+
+    view = ntfnUserWords[index - 1].view;
+    if (notification_ptr_get_state(ntfnPtr) == NtfnState_Active) {
+        view->badge = notification_ptr_get_ntfnMsgIdentifier(ntfnPtr);
+        view->pending = 1;
+    } else {
+        view->pending = 0;
+        view->badge = 0;
+    }
+}
+
+static void
+ntfnReleaseUserWordSlot(word_t index)
+{
+    ntfn_user_word_t *slot = &ntfnUserWords[index];
+
+    notification_ptr_set_ntfnUserWord(slot->ntfn, 0);
+    slot->ntfn = NULL;
+    slot->view = NULL;
+}
+
+/* Called when the last cap to a notification goes away */
+void
+ntfnReleaseUserWord(notification_t *ntfnPtr)
+{
+    word_t index = notification_ptr_get_ntfnUserWord(ntfnPtr);
+
+    if (index != 0) {
+        ntfnReleaseUserWordSlot(index - 1);
+    }
+}
+
+/* Called when the last cap to a frame goes away */
+void
+ntfnReleaseUserWordFrame(word_t base, word_t bytes)
+{
+    word_t i;
+
+    for (i = 0; i < CONFIG_NTFN_USER_WORD_SLOTS; i++) {
+        word_t view = (word_t) ntfnUserWords[i].view;
+        if (ntfnUserWords[i].ntfn != NULL && view >= base && view - base < bytes) {
+            ntfnReleaseUserWordSlot(i);
+        }
+    }
+}
+
+exception_t
+ntfnSetUserWord(word_t ntfn_cptr, word_t frame_cptr, word_t offset)
+{
+    lookupCap_ret_t lu_ret;
+    notification_t *ntfnPtr;
+    word_t index;
+
+    lu_ret = lookupCap(NODE_STATE(ksCurThread), ntfn_cptr);
+    if (unlikely(lu_ret.status != EXCEPTION_NONE)) {
+        userError("SysNtfnSetUserWord: invalid cap #%lu.", ntfn_cptr);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    if (cap_get_capType(lu_ret.cap) != cap_notification_cap ||
+            !cap_notification_cap_get_capNtfnCanReceive(lu_ret.cap)) {
+        userError("SysNtfnSetUserWord: cap #%lu is not a receivable notification.", ntfn_cptr);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+    ntfnPtr = NTFN_PTR(cap_notification_cap_get_capNtfnPtr(lu_ret.cap));
+
+    lu_ret = lookupCap(NODE_STATE(ksCurThread), frame_cptr);
+    if (unlikely(lu_ret.status != EXCEPTION_NONE)) {
+        userError("SysNtfnSetUserWord: invalid cap #%lu.", frame_cptr);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    /* a null frame cap stops publishing */
+    if (cap_get_capType(lu_ret.cap) == cap_null_cap) {
+        ntfnReleaseUserWord(ntfnPtr);
+        return EXCEPTION_NONE;
+    }
+
+    /* ntfnPublishUserWord writes the view, so the cap must allow writes */
+    if (cap_get_capType(lu_ret.cap) != cap_frame_cap ||
+            cap_frame_cap_get_capFIsDevice(lu_ret.cap) ||
+            cap_frame_cap_get_capFVMRights(lu_ret.cap) != VMReadWrite) {
+        userError("SysNtfnSetUserWord: cap #%lu is not a writable RAM frame.", frame_cptr);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    if (offset % sizeof(ntfn_user_view_t) != 0 ||
+            offset >= BIT(pageBitsForSize(cap_frame_cap_get_capFSize(lu_ret.cap)))) {
+        userError("SysNtfnSetUserWord: offset 0x%lx is misaligned or outside the frame.", offset);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    index = notification_ptr_get_ntfnUserWord(ntfnPtr);
+    if (index == 0) {
+        for (index = 1; index <= CONFIG_NTFN_USER_WORD_SLOTS; index++) {
+            if (ntfnUserWords[index - 1].ntfn == NULL) {
+                break;
+            }
+        }
+        if (index > CONFIG_NTFN_USER_WORD_SLOTS) {
+            userError("SysNtfnSetUserWord: all %d user word slots are in use.",
+                      (int) CONFIG_NTFN_USER_WORD_SLOTS);
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+    }
+
+    ntfnUserWords[index - 1].ntfn = ntfnPtr;
+    ntfnUserWords[index - 1].view = (ntfn_user_view_t *)
+                                    (cap_frame_cap_get_capFBasePtr(lu_ret.cap) + offset);
+    notification_ptr_set_ntfnUserWord(ntfnPtr, index);
+    ntfnPublishUserWord(ntfnPtr);
+
+    return EXCEPTION_NONE;
+}
+#endif /* CONFIG_NTFN_USER_WORD */
+
+#ifdef CONFIG_WAIT_SET
+/* A wait set is a notification that other notifications, its members,
+ * forward to. A member that becomes active signals the set with the bit it
+ * joined under and keeps its own badge, so one thread can wait on the set
+ * and then collect the member that fired together with its badge.
+ *
+ * Membership is an entry in waitSetMembers. A member keeps the index of
+ * its entry, plus one, in bits 48-63 of its fourth word above
+ * ntfnBoundTCB, and a set is marked in bit 48 of its second word above
+ * ntfnQueue_head. Both are padding that the generated setters leave
+ * alone. */
+#define NTFN_WAIT_SET_MEMBER_SHIFT 48
+#define NTFN_WAIT_SET_MEMBER_BITS 16
+#define NTFN_WAIT_SET_FLAG BIT(48)
+
+compile_assert(wait_set_slots_fit,
+               CONFIG_WAIT_SET_SLOTS < BIT(NTFN_WAIT_SET_MEMBER_BITS))
+
+typedef struct wait_set_member {
+    notification_t *member;
+    notification_t *set;
+    word_t bit;
+} wait_set_member_t;
 
-#include <types.h>
-#include <kernel/thread.h>
-#include <object/structures.h>
-#include <object/tcb.h>
-#include <object/endpoint.h>
-#include <model/statedata.h>
-#include <machine/io.h>
+static wait_set_member_t waitSetMembers[CONFIG_WAIT_SET_SLOTS];
 
-#include <object/notification.h>
+static inline word_t PURE
+notification_ptr_get_ntfnWaitSetMember(notification_t *ntfnPtr)
+{
+    return (ntfnPtr->words[3] >> NTFN_WAIT_SET_MEMBER_SHIFT) & MASK(NTFN_WAIT_SET_MEMBER_BITS);
+}
+
+static inline void
+notification_ptr_set_ntfnWaitSetMember(notification_t *ntfnPtr, word_t v)
+{
+    ntfnPtr->words[3] &= ~(MASK(NTFN_WAIT_SET_MEMBER_BITS) << NTFN_WAIT_SET_MEMBER_SHIFT);
+    ntfnPtr->words[3] |= (v & MASK(NTFN_WAIT_SET_MEMBER_BITS)) << NTFN_WAIT_SET_MEMBER_SHIFT;
+}
+
+static inline bool_t PURE
+notification_ptr_get_ntfnIsWaitSet(notification_t *ntfnPtr)
+{
+    return (ntfnPtr->words[1] & NTFN_WAIT_SET_FLAG) != 0;
+}
+
+static inline void
+notification_ptr_set_ntfnIsWaitSet(notification_t *ntfnPtr, bool_t v)
+{
+    ntfnPtr->words[1] &= ~NTFN_WAIT_SET_FLAG;
+    if (v) {
+        ntfnPtr->words[1] |= NTFN_WAIT_SET_FLAG;
+    }
+}
+
+static void waitSetWake(notification_t *setPtr, word_t badge);
+#endif /* CONFIG_WAIT_SET */
 
 static inline tcb_queue_t PURE
 ntfn_ptr_get_queue(notification_t *ntfnPtr)
@@ -7558,12 +10170,23 @@ ntfn_set_active(notification_t *ntfnPtr, word_t badge)
 {
     notification_ptr_set_state(ntfnPtr, NtfnState_Active);
     notification_ptr_set_ntfnMsgIdentifier(ntfnPtr, badge);
+#ifdef CONFIG_NTFN_USER_WORD
+    ntfnPublishUserWord(ntfnPtr);
+#endif
 }
 
 
 void
 sendSignal(notification_t *ntfnPtr, word_t badge)
 {
+#ifdef CONFIG_WAIT_SET
+    if (unlikely(notification_ptr_get_ntfnIsWaitSet(ntfnPtr) &&
+                 notification_ptr_get_state(ntfnPtr) == NtfnState_Waiting)) {
+        waitSetWake(ntfnPtr, badge);
+        return;
+    }
+#endif
+
     switch (notification_ptr_get_state(ntfnPtr)) {
     case NtfnState_Idle: {
         tcb_t *tcb = (tcb_t*)notification_ptr_get_ntfnBoundTCB(ntfnPtr);
@@ -7637,9 +10260,23 @@ sendSignal(notification_t *ntfnPtr, word_t badge)
         badge2 |= badge;
 
         notification_ptr_set_ntfnMsgIdentifier(ntfnPtr, badge2);
+#ifdef CONFIG_NTFN_USER_WORD
+        ntfnPublishUserWord(ntfnPtr);
+#endif
         break;
     }
     }
+
+#ifdef CONFIG_WAIT_SET
+    /* A member that nobody took the signal from directly tells its set.
+     * Sets cannot be members, so this recurses at most once. */
+    if (unlikely(notification_ptr_get_ntfnWaitSetMember(ntfnPtr) != 0) &&
+            notification_ptr_get_state(ntfnPtr) == NtfnState_Active) {
+        wait_set_member_t *entry =
+            &waitSetMembers[notification_ptr_get_ntfnWaitSetMember(ntfnPtr) - 1];
+        sendSignal(entry->set, BIT(entry->bit));
+    }
+#endif
 }
 
 void
@@ -7680,6 +10317,9 @@ receiveSignal(tcb_t *thread, cap_t cap, bool_t isBlocking)
             thread, badgeRegister,
             notification_ptr_get_ntfnMsgIdentifier(ntfnPtr));
         notification_ptr_set_state(ntfnPtr, NtfnState_Idle);
+#ifdef CONFIG_NTFN_USER_WORD
+        ntfnPublishUserWord(ntfnPtr);
+#endif
         break;
     }
 }
@@ -7734,6 +10374,9 @@ completeSignal(notification_t *ntfnPtr, tcb_t *tcb)
         badge = notification_ptr_get_ntfnMsgIdentifier(ntfnPtr);
         setRegister(tcb, badgeRegister, badge);
         notification_ptr_set_state(ntfnPtr, NtfnState_Idle);
+#ifdef CONFIG_NTFN_USER_WORD
+        ntfnPublishUserWord(ntfnPtr);
+#endif
     } else {
         fail("tried to complete signal with inactive notification object");
     }
@@ -7775,6 +10418,217 @@ bindNotification(tcb_t *tcb, notification_t *ntfnPtr)
     tcb->tcbBoundNotification = ntfnPtr;
 }
 
+#ifdef CONFIG_WAIT_SET
+/* Threads waiting on a set are restarted rather than handed the set's
+ * mask, so that a SysWaitSetRecv runs again and returns a member. Every
+ * waiter is restarted; those that find nothing left block again. */
+static void
+waitSetWake(notification_t *setPtr, word_t badge)
+{
+    cancelAllSignals(setPtr);
+    ntfn_set_active(setPtr, badge);
+}
+
+/* As receiveSignal on an active notification */
+static word_t
+waitSetTake(notification_t *ntfnPtr)
+{
+    word_t badge = notification_ptr_get_ntfnMsgIdentifier(ntfnPtr);
+
+    notification_ptr_set_state(ntfnPtr, NtfnState_Idle);
+#ifdef CONFIG_NTFN_USER_WORD
+    ntfnPublishUserWord(ntfnPtr);
+#endif
+    return badge;
+}
+
+static notification_t *
+waitSetMemberFor(notification_t *setPtr, word_t bit)
+{
+    word_t i;
+
+    for (i = 0; i < CONFIG_WAIT_SET_SLOTS; i++) {
+        if (waitSetMembers[i].set == setPtr && waitSetMembers[i].bit == bit) {
+            return waitSetMembers[i].member;
+        }
+    }
+    return NULL;
+}
+
+/* Returns false if the notification is not a wait set */
+bool_t
+receiveWaitSet(tcb_t *thread, cap_t cap)
+{
+    notification_t *setPtr;
+
+    setPtr = NTFN_PTR(cap_notification_cap_get_capNtfnPtr(cap));
+    if (!notification_ptr_get_ntfnIsWaitSet(setPtr)) {
+        return false;
+    }
+
+    while (notification_ptr_get_state(setPtr) == NtfnState_Active) {
+        word_t pending = waitSetTake(setPtr);
+        notification_t *member;
+        word_t bit;
+
+        if (pending == 0) {
+            continue;
+        }
+
+        bit = ctzl(pending);
+        if (pending & ~BIT(bit)) {
+            ntfn_set_active(setPtr, pending & ~BIT(bit));
+        }
+
+        /* The member may have left, or been received from directly, since
+         * it fired; its bit is then stale and is dropped */
+        member = waitSetMemberFor(setPtr, bit);
+        if (member != NULL && notification_ptr_get_state(member) == NtfnState_Active) {
+            setRegister(thread, badgeRegister, waitSetTake(member));
+            setRegister(thread, msgInfoRegister, bit);
+            return true;
+        }
+    }
+
+    receiveSignal(thread, cap, true);
+    return true;
+}
+
+static void
+waitSetReleaseSlot(word_t index)
+{
+    wait_set_member_t *entry = &waitSetMembers[index];
+    notification_t *setPtr = entry->set;
+    word_t i;
+
+    notification_ptr_set_ntfnWaitSetMember(entry->member, 0);
+    entry->member = NULL;
+    entry->set = NULL;
+    entry->bit = 0;
+
+    /* A set goes back to being a plain notification with its last member.
+     * Its waiters blocked expecting to be restarted by waitSetWake, not
+     * handed a badge, so restart them now; SysWaitSetRecv then receives
+     * from the set as a plain notification. */
+    for (i = 0; i < CONFIG_WAIT_SET_SLOTS; i++) {
+        if (waitSetMembers[i].set == setPtr) {
+            return;
+        }
+    }
+    cancelAllSignals(setPtr);
+    notification_ptr_set_ntfnIsWaitSet(setPtr, false);
+}
+
+/* Called when the last cap to a notification goes away */
+void
+waitSetRelease(notification_t *ntfnPtr)
+{
+    word_t i;
+
+    if (notification_ptr_get_ntfnWaitSetMember(ntfnPtr) != 0) {
+        waitSetReleaseSlot(notification_ptr_get_ntfnWaitSetMember(ntfnPtr) - 1);
+    }
+
+    if (notification_ptr_get_ntfnIsWaitSet(ntfnPtr)) {
+        for (i = 0; i < CONFIG_WAIT_SET_SLOTS; i++) {
+            if (waitSetMembers[i].set == ntfnPtr) {
+                waitSetReleaseSlot(i);
+            }
+        }
+    }
+}
+
+exception_t
+waitSetJoin(word_t set_cptr, word_t member_cptr, word_t bit)
+{
+    lookupCap_ret_t lu_ret;
+    notification_t *memberPtr;
+    notification_t *setPtr;
+    notification_t *holder;
+    word_t index;
+
+    lu_ret = lookupCap(NODE_STATE(ksCurThread), member_cptr);
+    if (unlikely(lu_ret.status != EXCEPTION_NONE)) {
+        userError("SysWaitSetJoin: invalid cap #%lu.", member_cptr);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    if (cap_get_capType(lu_ret.cap) != cap_notification_cap ||
+            !cap_notification_cap_get_capNtfnCanReceive(lu_ret.cap)) {
+        userError("SysWaitSetJoin: cap #%lu is not a receivable notification.", member_cptr);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+    memberPtr = NTFN_PTR(cap_notification_cap_get_capNtfnPtr(lu_ret.cap));
+
+    lu_ret = lookupCap(NODE_STATE(ksCurThread), set_cptr);
+    if (unlikely(lu_ret.status != EXCEPTION_NONE)) {
+        userError("SysWaitSetJoin: invalid cap #%lu.", set_cptr);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    /* a null set cap takes the member out of its set */
+    if (cap_get_capType(lu_ret.cap) == cap_null_cap) {
+        if (notification_ptr_get_ntfnWaitSetMember(memberPtr) != 0) {
+            waitSetReleaseSlot(notification_ptr_get_ntfnWaitSetMember(memberPtr) - 1);
+        }
+        return EXCEPTION_NONE;
+    }
+
+    if (cap_get_capType(lu_ret.cap) != cap_notification_cap ||
+            !cap_notification_cap_get_capNtfnCanSend(lu_ret.cap)) {
+        userError("SysWaitSetJoin: cap #%lu is not a sendable notification.", set_cptr);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+    setPtr = NTFN_PTR(cap_notification_cap_get_capNtfnPtr(lu_ret.cap));
+
+    if (setPtr == memberPtr || notification_ptr_get_ntfnIsWaitSet(memberPtr) ||
+            notification_ptr_get_ntfnWaitSetMember(setPtr) != 0) {
+        userError("SysWaitSetJoin: a wait set cannot be a member of a wait set.");
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    if (bit >= wordBits) {
+        userError("SysWaitSetJoin: bit %lu is out of range.", bit);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    holder = waitSetMemberFor(setPtr, bit);
+    if (holder != NULL && holder != memberPtr) {
+        userError("SysWaitSetJoin: bit %lu is already in use.", bit);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    index = notification_ptr_get_ntfnWaitSetMember(memberPtr);
+    if (index != 0) {
+        waitSetReleaseSlot(index - 1);
+    } else {
+        for (index = 1; index <= CONFIG_WAIT_SET_SLOTS; index++) {
+            if (waitSetMembers[index - 1].member == NULL) {
+                break;
+            }
+        }
+        if (index > CONFIG_WAIT_SET_SLOTS) {
+            userError("SysWaitSetJoin: all %d member slots are in use.",
+                      (int) CONFIG_WAIT_SET_SLOTS);
+            return EXCEPTION_SYSCALL_ERROR;
+        }
+    }
+
+    waitSetMembers[index - 1].member = memberPtr;
+    waitSetMembers[index - 1].set = setPtr;
+    waitSetMembers[index - 1].bit = bit;
+    notification_ptr_set_ntfnWaitSetMember(memberPtr, index);
+    notification_ptr_set_ntfnIsWaitSet(setPtr, true);
+
+    /* A member that fired before joining still has to be seen */
+    if (notification_ptr_get_state(memberPtr) == NtfnState_Active) {
+        sendSignal(setPtr, BIT(bit));
+    }
+
+    return EXCEPTION_NONE;
+}
+#endif /* CONFIG_WAIT_SET */
+
 #line 1 "/home/sandip/Desktop/test/seL/kernel/src/object/objecttype.c"
 /*
  * Copyright 2014, General Dynamics C4 Systems
@@ -7886,6 +10740,9 @@ finaliseCap(cap_t cap, bool_t final, bool_t exposed)
     case cap_endpoint_cap:
         if (final) {
             cancelAllIPC(EP_PTR(cap_endpoint_cap_get_capEPPtr(cap)));
+#ifdef CONFIG_EP_PRIORITY_QUEUES
+            epReleasePriorityOrdered(EP_PTR(cap_endpoint_cap_get_capEPPtr(cap)));
+#endif
         }
 
         fc_ret.remainder = cap_null_cap_new();
@@ -7898,6 +10755,15 @@ finaliseCap(cap_t cap, bool_t final, bool_t exposed)
 
             unbindMaybeNotification(ntfn);
             cancelAllSignals(ntfn);
+#ifdef CONFIG_PROFILER_SAMPLING
+            profilerReleaseNotification(ntfn);
+#endif
+#ifdef CONFIG_NTFN_USER_WORD
+            ntfnReleaseUserWord(ntfn);
+#endif
+#ifdef CONFIG_WAIT_SET
+            waitSetRelease(ntfn);
+#endif
         }
         fc_ret.remainder = cap_null_cap_new();
         fc_ret.cleanupInfo = cap_null_cap_new();
@@ -10146,6 +13012,8 @@ setMRs_syscall_error(tcb_t *thread, word_t *receiveIPCBuffer)
 #include <object/cnode.h>
 #include <kernel/cspace.h>
 #include <kernel/thread.h>
+#include <benchmark/benchmark.h>
+#include <benchmark/kernel_tracepoints.h>
 #include <util.h>
 
 static word_t
@@ -10154,6 +13022,151 @@ alignUp(word_t baseValue, word_t alignment)
     return (baseValue + (BIT(alignment) - 1)) & ~MASK(alignment);
 }
 
+/* Optional flags word of a retype, the seventh message word */
+#define RETYPE_FLAG_EP_PRIORITY_ORDERED BIT(0)
+#ifdef CONFIG_EP_PRIORITY_QUEUES
+#define RETYPE_FLAGS_VALID RETYPE_FLAG_EP_PRIORITY_ORDERED
+#else
+#define RETYPE_FLAGS_VALID 0
+#endif
+
+/* Message words and flags word of an untyped description */
+#define UNTYPED_DESCRIPTION_WORDS  3
+#define UNTYPED_DESCRIPTION_VALID  BIT(0)
+#define UNTYPED_DESCRIPTION_DEVICE BIT(1)
+
+/* Describe the cap in slot for capacity planning as three message words:
+ * the bytes a retype could still use, the size in bits of the largest
+ * naturally aligned block within them, and flags. Anything other than an
+ * untyped is described as zeros. */
+static word_t
+setMRs_untypedDescription(tcb_t *thread, word_t *receiveIPCBuffer,
+                          word_t offset, cte_t *slot)
+{
+    cap_t cap = slot->cap;
+    word_t freeIndex, freeRef, top, bits;
+    word_t freeBytes = 0, largest = 0, flags = 0;
+
+    if (cap_get_capType(cap) == cap_untyped_cap) {
+        /* As for a retype, an untyped without children will be reset and is
+         * entirely free */
+        if (ensureNoChildren(slot) != EXCEPTION_NONE) {
+            freeIndex = cap_untyped_cap_get_capFreeIndex(cap);
+        } else {
+            freeIndex = 0;
+        }
+        freeRef = GET_FREE_REF(cap_untyped_cap_get_capPtr(cap), freeIndex);
+        top = cap_untyped_cap_get_capPtr(cap) + BIT(cap_untyped_cap_get_capBlockSize(cap));
+        freeBytes = top - freeRef;
+
+        /* top is aligned to every block size up to the untyped's own, so
+         * the first size that fits once aligned up is the largest */
+        for (bits = cap_untyped_cap_get_capBlockSize(cap); freeBytes != 0; bits--) {
+            if (alignUp(freeRef, bits) + BIT(bits) <= top) {
+                largest = bits;
+                break;
+            }
+        }
+
+        flags = UNTYPED_DESCRIPTION_VALID;
+        if (cap_untyped_cap_get_capIsDevice(cap)) {
+            flags |= UNTYPED_DESCRIPTION_DEVICE;
+        }
+    }
+
+    offset = setMR(thread, receiveIPCBuffer, offset, freeBytes);
+    offset = setMR(thread, receiveIPCBuffer, offset, largest);
+    return setMR(thread, receiveIPCBuffer, offset, flags);
+}
+
+/* Describe count consecutive slots starting at slot */
+static exception_t
+invokeUntyped_Describe(cte_t *slot, word_t count, bool_t call)
+{
+    tcb_t *thread = NODE_STATE(ksCurThread);
+    word_t i, length = 0;
+
+    if (call) {
+        word_t *ipcBuffer = lookupIPCBuffer(true, thread);
+
+        for (i = 0; i < count; i++) {
+            length = setMRs_untypedDescription(thread, ipcBuffer, length, slot + i);
+        }
+        setRegister(thread, badgeRegister, 0);
+        setRegister(thread, msgInfoRegister, wordFromMessageInfo(
+                        seL4_MessageInfo_new(0, 0, 0, length)));
+    }
+    setThreadState(thread, ThreadState_Running);
+
+    return EXCEPTION_NONE;
+}
+
+static exception_t
+decodeUntypedDescribeRange(word_t length, extra_caps_t excaps,
+                           bool_t call, word_t *buffer)
+{
+    word_t nodeIndex, nodeDepth, nodeOffset, count;
+    word_t nodeSize, maxCount;
+    cap_t nodeCap;
+    lookupSlot_ret_t lu_ret;
+
+    if (length < 4 || excaps.excaprefs[0] == NULL) {
+        userError("Untyped DescribeRange: Truncated message.");
+        current_syscall_error.type = seL4_TruncatedMessage;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    nodeIndex  = getSyscallArg(0, buffer);
+    nodeDepth  = getSyscallArg(1, buffer);
+    nodeOffset = getSyscallArg(2, buffer);
+    count      = getSyscallArg(3, buffer);
+
+    /* Lookup the CNode holding the range, as Retype does its destination */
+    if (nodeDepth == 0) {
+        nodeCap = excaps.excaprefs[0]->cap;
+    } else {
+        lu_ret = lookupTargetSlot(excaps.excaprefs[0]->cap, nodeIndex, nodeDepth);
+        if (lu_ret.status != EXCEPTION_NONE) {
+            userError("Untyped DescribeRange: Invalid CNode address.");
+            return lu_ret.status;
+        }
+        nodeCap = lu_ret.slot->cap;
+    }
+
+    if (cap_get_capType(nodeCap) != cap_cnode_cap) {
+        userError("Untyped DescribeRange: CNode cap invalid.");
+        current_syscall_error.type = seL4_FailedLookup;
+        current_syscall_error.failedLookupWasSource = 1;
+        current_lookup_fault = lookup_fault_missing_capability_new(nodeDepth);
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    nodeSize = BIT(cap_cnode_cap_get_capCNodeRadix(nodeCap));
+    if (nodeOffset > nodeSize - 1) {
+        userError("Untyped DescribeRange: Node offset #%d too large.",
+                  (int)nodeOffset);
+        current_syscall_error.type = seL4_RangeError;
+        current_syscall_error.rangeErrorMin = 0;
+        current_syscall_error.rangeErrorMax = nodeSize - 1;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    maxCount = MIN(nodeSize - nodeOffset,
+                   seL4_MsgMaxLength / UNTYPED_DESCRIPTION_WORDS);
+    if (count < 1 || count > maxCount) {
+        userError("Untyped DescribeRange: Number of slots (%d) too small or large.",
+                  (int)count);
+        current_syscall_error.type = seL4_RangeError;
+        current_syscall_error.rangeErrorMin = 1;
+        current_syscall_error.rangeErrorMax = maxCount;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
+    setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+    return invokeUntyped_Describe(CTE_PTR(cap_cnode_cap_get_capCNodePtr(nodeCap)) + nodeOffset,
+                                  count, call);
+}
+
 exception_t
 decodeUntypedInvocation(word_t invLabel, word_t length, cte_t *slot,
                         cap_t cap, extra_caps_t excaps,
@@ -10161,6 +13174,7 @@ decodeUntypedInvocation(word_t invLabel, word_t length, cte_t *slot,
 {
     word_t newType, userObjSize, nodeIndex;
     word_t nodeDepth, nodeOffset, nodeWindow;
+    word_t retypeFlags = 0;
     cte_t *rootSlot UNUSED;
     exception_t status;
     cap_t nodeCap;
@@ -10173,6 +13187,15 @@ decodeUntypedInvocation(word_t invLabel, word_t length, cte_t *slot,
     bool_t deviceMemory;
     bool_t reset;
 
+    if (invLabel == UntypedDescribe) {
+        setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
+        return invokeUntyped_Describe(slot, 1, call);
+    }
+
+    if (invLabel == UntypedDescribeRange) {
+        return decodeUntypedDescribeRange(length, excaps, call, buffer);
+    }
+
     /* Ensure operation is valid. */
     if (invLabel != UntypedRetype) {
         userError("Untyped cap: Illegal operation attempted.");
@@ -10194,6 +13217,9 @@ decodeUntypedInvocation(word_t invLabel, word_t length, cte_t *slot,
     nodeDepth   = getSyscallArg(3, buffer);
     nodeOffset  = getSyscallArg(4, buffer);
     nodeWindow  = getSyscallArg(5, buffer);
+    if (length > 6) {
+        retypeFlags = getSyscallArg(6, buffer);
+    }
 
     rootSlot = excaps.excaprefs[0];
 
@@ -10218,6 +13244,16 @@ decodeUntypedInvocation(word_t invLabel, word_t length, cte_t *slot,
         return EXCEPTION_SYSCALL_ERROR;
     }
 
+    /* Are the flags known, and do they apply to the requested type? */
+    if ((retypeFlags & ~RETYPE_FLAGS_VALID) ||
+            ((retypeFlags & RETYPE_FLAG_EP_PRIORITY_ORDERED) &&
+             newType != seL4_EndpointObject)) {
+        userError("Untyped Retype: Invalid flags.");
+        current_syscall_error.type = seL4_InvalidArgument;
+        current_syscall_error.invalidArgumentNumber = 6;
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+
     /* If the target object is a CNode, is it at least size 1? */
     if (newType == seL4_CapTableObject && userObjSize == 0) {
         userError("Untyped Retype: Requested CapTable size too small.");
@@ -10282,6 +13318,17 @@ decodeUntypedInvocation(word_t invLabel, word_t length, cte_t *slot,
         return EXCEPTION_SYSCALL_ERROR;
     }
 
+#ifdef CONFIG_EP_PRIORITY_QUEUES
+    if ((retypeFlags & RETYPE_FLAG_EP_PRIORITY_ORDERED) &&
+            nodeWindow > epPriorityOrderedSlotsFree()) {
+        userError("Untyped Retype: Too few priority ordered endpoint slots left.");
+        current_syscall_error.type = seL4_RangeError;
+        current_syscall_error.rangeErrorMin = 1;
+        current_syscall_error.rangeErrorMax = epPriorityOrderedSlotsFree();
+        return EXCEPTION_SYSCALL_ERROR;
+    }
+#endif
+
     /* Ensure that the destination slots are all empty. */
     slots.cnode = CTE_PTR(cap_cnode_cap_get_capCNodePtr(nodeCap));
     slots.offset = nodeOffset;
@@ -10353,9 +13400,20 @@ decodeUntypedInvocation(word_t invLabel, word_t length, cte_t *slot,
 
     /* Perform the retype. */
     setThreadState(NODE_STATE(ksCurThread), ThreadState_Restart);
-    return invokeUntyped_Retype(slot, reset,
-                                (void*)alignedFreeRef, newType, userObjSize,
-                                slots, deviceMemory);
+    status = invokeUntyped_Retype(slot, reset,
+                                  (void*)alignedFreeRef, newType, userObjSize,
+                                  slots, deviceMemory);
+
+#ifdef CONFIG_EP_PRIORITY_QUEUES
+    if (status == EXCEPTION_NONE &&
+            (retypeFlags & RETYPE_FLAG_EP_PRIORITY_ORDERED)) {
+        for (i = nodeOffset; i < nodeOffset + nodeWindow; i++) {
+            epSetPriorityOrdered(EP_PTR(cap_endpoint_cap_get_capEPPtr(slots.cnode[i].cap)));
+        }
+    }
+#endif
+
+    return status;
 }
 
 static exception_t
@@ -10411,7 +13469,9 @@ invokeUntyped_Retype(cte_t *srcSlot,
     freeRef = GET_FREE_REF(regionBase, cap_untyped_cap_get_capFreeIndex(srcSlot->cap));
 
     if (reset) {
+        TRACE_POINT_START(TRACE_POINT_RESET_UNTYPED);
         status = resetUntypedCap(srcSlot);
+        TRACE_POINT_STOP(TRACE_POINT_RESET_UNTYPED);
         if (status != EXCEPTION_NONE) {
             return status;
         }
@@ -10762,7 +13822,6 @@ maskInterrupt(bool_t disable, interrupt_t irq)
 bool_t CONST
 isReservedIRQ(irq_t irq)
 {
-    printf("isReservedIRQ \n");
     return false;
 }
 
@@ -10770,7 +13829,6 @@ isReservedIRQ(irq_t irq)
 void
 handleReservedIRQ(irq_t irq)
 {
-    printf("handleReservedIRQ \n");
 }
 
 void
@@ -10839,16 +13897,68 @@ initTimer(void)
     sbi_set_timer(get_cycles() + RESET_CYCLES);
 }
 
+#ifdef CONFIG_RISCV_ZICBOM
+/* Zicbom block operations, written with .insn for assemblers that do not
+ * know them: cbo.inval, cbo.clean and cbo.flush are MISC-MEM with funct3 2
+ * and 0, 1 and 2 in the immediate. They work on the kernel window alias of
+ * the range, which shares cache lines with any user mapping. */
+#define CBO_BLOCK_BITS CONFIG_RISCV_CBOM_BLOCK_BITS
+
+static inline void
+cbo_inval(word_t addr)
+{
+    __asm__ volatile(".insn i 0x0f, 2, x0, %0, 0" :: "r"(addr) : "memory");
+}
+
+static inline void
+cbo_clean(word_t addr)
+{
+    __asm__ volatile(".insn i 0x0f, 2, x0, %0, 1" :: "r"(addr) : "memory");
+}
+
+static inline void
+cbo_flush(word_t addr)
+{
+    __asm__ volatile(".insn i 0x0f, 2, x0, %0, 2" :: "r"(addr) : "memory");
+}
+
+/* The ranges are inclusive of end */
 void plat_cleanL2Range(paddr_t start, paddr_t end)
 {
+    paddr_t line;
+
+    for (line = ROUND_DOWN(start, CBO_BLOCK_BITS); line <= end; line += BIT(CBO_BLOCK_BITS)) {
+        cbo_clean((word_t) ptrFromPAddr(line));
+    }
+    __asm__ volatile("fence iorw, iorw" ::: "memory");
 }
+
 void plat_invalidateL2Range(paddr_t start, paddr_t end)
 {
+    paddr_t line;
+
+    __asm__ volatile("fence iorw, iorw" ::: "memory");
+    for (line = ROUND_DOWN(start, CBO_BLOCK_BITS); line <= end; line += BIT(CBO_BLOCK_BITS)) {
+        /* Blocks only partly in the range hold data that must survive */
+        if (line < start || line + BIT(CBO_BLOCK_BITS) - 1 > end) {
+            cbo_flush((word_t) ptrFromPAddr(line));
+        } else {
+            cbo_inval((word_t) ptrFromPAddr(line));
+        }
+    }
+    __asm__ volatile("fence iorw, iorw" ::: "memory");
 }
 
 void plat_cleanInvalidateL2Range(paddr_t start, paddr_t end)
 {
+    paddr_t line;
+
+    for (line = ROUND_DOWN(start, CBO_BLOCK_BITS); line <= end; line += BIT(CBO_BLOCK_BITS)) {
+        cbo_flush((word_t) ptrFromPAddr(line));
+    }
+    __asm__ volatile("fence iorw, iorw" ::: "memory");
 }
+#endif /* CONFIG_RISCV_ZICBOM */
 
 /**
    DONT_TRANSLATE
@@ -10871,7 +13981,6 @@ void
 handleSpuriousIRQ(void)
 {
     /* Do nothing */
-    printf("Superior IRQ!! \n");
 }
 #line 1 "/home/sandip/Desktop/test/seL/kernel/src/smp/ipi.c"
 /*
@@ -57,9 +57,18 @@ SECTIONS
         /* Sit inside a large frame */
         . = ALIGN(4K);
 
+        /* Hot paths first: the trap, fastpath and scheduler code is marked
+         * SECTION(".text.hot") so a kernel round trip touches as few I-cache
+         * lines and pages as possible */
+        *(.text.hot)
+        *(.text.hot.*)
 
         /* Standard kernel */
         *(.text)
+
+        /* Code the compiler already knows to be cold */
+        *(.text.unlikely)
+        *(.text.unlikely.*)
     }
 
     /* Start of data section */
@@ -80,6 +89,11 @@ SECTIONS
 
     .data . : AT(ADDR(.data) - KERNEL_OFFSET)
     {
+        /* Scheduler state marked SECTION(".data.hot"), together and starting
+         * on a cache line. It stays out of the gp window: trap entry does
+         * not load the kernel's gp, so gp may still hold the user value. */
+        . = ALIGN(64);
+        *(.data.hot)
         *(.data)
     }
 
@@ -68,6 +68,14 @@ struct seL4_TCB_ConfigureSingleStepping {
 };
 typedef struct seL4_TCB_ConfigureSingleStepping seL4_TCB_ConfigureSingleStepping_t;
 
+struct seL4_Untyped_Describe {
+	int error;
+	seL4_Word free_bytes;
+	seL4_Word largest_block_bits;
+	seL4_Word flags;
+};
+typedef struct seL4_Untyped_Describe seL4_Untyped_Describe_t;
+
 /*
  * Generated stubs.
  */
@@ -166,6 +174,115 @@ seL4_RISCV_PageTable_Unmap(seL4_RISCV_PageTable _service)
 	return result;
 }
 
+/**
+ * @xmlonly <manual name="MapFrames" label="riscv_pagetable_mapframes"/> @endxmlonly
+ * @brief @xmlonly Map a run of frames into a VSpace. @endxmlonly
+ * 
+ * @xmlonly
+ * Installs the <texttt text="Page"/> capabilities held in a contiguous range of slots
+ * of a CNode at consecutive virtual addresses, starting at the given address, with
+ * the same rights and attributes for every page. All pages must be the same size,
+ * and the paging structures for the whole range must already be present.
+ * Every page and target entry is checked before any page is mapped, so a failed
+ * call maps nothing. At most the Retype fan-out limit of pages can be mapped by
+ * one call. Pages already mapped at their place in the run are skipped, which
+ * lets a preempted call continue where it stopped.
+ * @endxmlonly
+ * 
+ * @param[in] _service Capability to the VSpace, or top-level page table, to map into.
+ * @param[in] cnode CNode holding the page capabilities. 
+ * @param[in] index Slot in the CNode of the first page. 
+ * @param[in] count Number of pages to map. 
+ * @param[in] vaddr Virtual address at which to map the first page. 
+ * @param[in] rights Rights for the mappings.  @xmlonly <docref>Possible values for this type are given in <autoref label="sec:cap_rights"/>.</docref> @endxmlonly 
+ * @param[in] attr VM Attributes for the mappings.  @xmlonly <docref>Possible values for this type are given in <autoref label="ch:vspace"/>.</docref> @endxmlonly 
+ * @return @xmlonly <errorenumdesc/> @endxmlonly
+ */
+LIBSEL4_INLINE seL4_Error
+seL4_RISCV_PageTable_MapFrames(seL4_RISCV_PageTable _service, seL4_CNode cnode, seL4_Word index, seL4_Word count, seL4_Word vaddr, seL4_CapRights_t rights, seL4_RISCV_VMAttributes attr)
+{
+	seL4_Error result;
+	seL4_MessageInfo_t tag = seL4_MessageInfo_new(RISCVPageTableMapFrames, 0, 1, 5);
+	seL4_MessageInfo_t output_tag;
+	seL4_Word mr0;
+	seL4_Word mr1;
+	seL4_Word mr2;
+	seL4_Word mr3;
+
+	/* Setup input capabilities. */
+	seL4_SetCap(0, cnode);
+
+	/* Marshal and initialise parameters. */
+	mr0 = index;
+	mr1 = count;
+	mr2 = vaddr;
+	mr3 = rights.words[0];
+	seL4_SetMR(4, attr);
+
+	/* Perform the call, passing in-register arguments directly. */
+	output_tag = seL4_CallWithMRs(_service, tag,
+		&mr0, &mr1, &mr2, &mr3);
+	result = (seL4_Error) seL4_MessageInfo_get_label(output_tag);
+
+	/* Unmarshal registers into IPC buffer on error. */
+	if (result != seL4_NoError) {
+		seL4_SetMR(0, mr0);
+		seL4_SetMR(1, mr1);
+		seL4_SetMR(2, mr2);
+		seL4_SetMR(3, mr3);
+	}
+
+	return result;
+}
+
+/**
+ * @xmlonly <manual name="Teardown" label="riscv_pagetable_teardown"/> @endxmlonly
+ * @brief @xmlonly Tear down a whole VSpace. @endxmlonly
+ * 
+ * @xmlonly
+ * Removes every mapping from a VSpace, or top-level <texttt text="Page Table"/>, and
+ * releases its ASID, leaving the page table unmapped so that it can be assigned
+ * again. Capabilities to pages and page tables that were mapped into it keep their
+ * mapping information; unmapping or deleting them afterwards is cheap as the ASID
+ * no longer refers to this VSpace. This must be the only capability to the page table.
+ * @endxmlonly
+ * 
+ * @param[in] _service Capability to the VSpace to tear down.
+ * @return @xmlonly <errorenumdesc/> @endxmlonly
+ */
+LIBSEL4_INLINE seL4_Error
+seL4_RISCV_PageTable_Teardown(seL4_RISCV_PageTable _service)
+{
+	seL4_Error result;
+	seL4_MessageInfo_t tag = seL4_MessageInfo_new(RISCVPageTableTeardown, 0, 0, 0);
+	seL4_MessageInfo_t output_tag;
+	seL4_Word mr0;
+	seL4_Word mr1;
+	seL4_Word mr2;
+	seL4_Word mr3;
+
+	/* Marshal and initialise parameters. */
+	mr0 = 0;
+	mr1 = 0;
+	mr2 = 0;
+	mr3 = 0;
+
+	/* Perform the call, passing in-register arguments directly. */
+	output_tag = seL4_CallWithMRs(_service, tag,
+		&mr0, &mr1, &mr2, &mr3);
+	result = (seL4_Error) seL4_MessageInfo_get_label(output_tag);
+
+	/* Unmarshal registers into IPC buffer on error. */
+	if (result != seL4_NoError) {
+		seL4_SetMR(0, mr0);
+		seL4_SetMR(1, mr1);
+		seL4_SetMR(2, mr2);
+		seL4_SetMR(3, mr3);
+	}
+
+	return result;
+}
+
 /**
  * @xmlonly <manual name="Map" label="riscv_page_map"/> @endxmlonly
  * @brief @xmlonly Map a page into a page table. @endxmlonly
@@ -368,6 +485,194 @@ seL4_RISCV_Page_GetAddress(seL4_RISCV_Page _service)
 	return result;
 }
 
+/**
+ * @xmlonly <manual name="Clean Data" label="riscv_page_clean_data"/> @endxmlonly
+ * @brief @xmlonly Clean cached pages within a frame @endxmlonly
+ * 
+ * @xmlonly
+ * Write back any dirty cache lines in the range to memory, with Zicbom cbo.clean.
+ * Fails with seL4_IllegalOperation if the kernel is not configured for Zicbom.
+ * @endxmlonly
+ * 
+ * @param[in] _service Capability to the page to invoke.
+ * @param[in] start_offset The offset, relative to the start of the page inclusive. 
+ * @param[in] end_offset The offset, relative to the start of the page exclusive. 
+ * @return @xmlonly <errorenumdesc/> @endxmlonly
+ */
+LIBSEL4_INLINE seL4_Error
+seL4_RISCV_Page_Clean_Data(seL4_RISCV_Page _service, seL4_Word start_offset, seL4_Word end_offset)
+{
+	seL4_Error result;
+	seL4_MessageInfo_t tag = seL4_MessageInfo_new(RISCVPageClean_Data, 0, 0, 2);
+	seL4_MessageInfo_t output_tag;
+	seL4_Word mr0;
+	seL4_Word mr1;
+	seL4_Word mr2;
+	seL4_Word mr3;
+
+	/* Marshal and initialise parameters. */
+	mr0 = start_offset;
+	mr1 = end_offset;
+	mr2 = 0;
+	mr3 = 0;
+
+	/* Perform the call, passing in-register arguments directly. */
+	output_tag = seL4_CallWithMRs(_service, tag,
+		&mr0, &mr1, &mr2, &mr3);
+	result = (seL4_Error) seL4_MessageInfo_get_label(output_tag);
+
+	/* Unmarshal registers into IPC buffer on error. */
+	if (result != seL4_NoError) {
+		seL4_SetMR(0, mr0);
+		seL4_SetMR(1, mr1);
+		seL4_SetMR(2, mr2);
+		seL4_SetMR(3, mr3);
+	}
+
+	return result;
+}
+
+/**
+ * @xmlonly <manual name="Invalidate Data" label="riscv_page_invalidate_data"/> @endxmlonly
+ * @brief @xmlonly Invalidate cached pages within a frame @endxmlonly
+ * 
+ * @xmlonly
+ * Discard cached copies of the range, with Zicbom cbo.inval. Lines only partly inside the
+ * range are written back first. Requires a writable frame capability. Fails with
+ * seL4_IllegalOperation if the kernel is not configured for Zicbom.
+ * @endxmlonly
+ * 
+ * @param[in] _service Capability to the page to invoke.
+ * @param[in] start_offset The offset, relative to the start of the page inclusive. 
+ * @param[in] end_offset The offset, relative to the start of the page exclusive. 
+ * @return @xmlonly <errorenumdesc/> @endxmlonly
+ */
+LIBSEL4_INLINE seL4_Error
+seL4_RISCV_Page_Invalidate_Data(seL4_RISCV_Page _service, seL4_Word start_offset, seL4_Word end_offset)
+{
+	seL4_Error result;
+	seL4_MessageInfo_t tag = seL4_MessageInfo_new(RISCVPageInvalidate_Data, 0, 0, 2);
+	seL4_MessageInfo_t output_tag;
+	seL4_Word mr0;
+	seL4_Word mr1;
+	seL4_Word mr2;
+	seL4_Word mr3;
+
+	/* Marshal and initialise parameters. */
+	mr0 = start_offset;
+	mr1 = end_offset;
+	mr2 = 0;
+	mr3 = 0;
+
+	/* Perform the call, passing in-register arguments directly. */
+	output_tag = seL4_CallWithMRs(_service, tag,
+		&mr0, &mr1, &mr2, &mr3);
+	result = (seL4_Error) seL4_MessageInfo_get_label(output_tag);
+
+	/* Unmarshal registers into IPC buffer on error. */
+	if (result != seL4_NoError) {
+		seL4_SetMR(0, mr0);
+		seL4_SetMR(1, mr1);
+		seL4_SetMR(2, mr2);
+		seL4_SetMR(3, mr3);
+	}
+
+	return result;
+}
+
+/**
+ * @xmlonly <manual name="Clean and Invalidate Data" label="riscv_page_clean_invalidate_data"/> @endxmlonly
+ * @brief @xmlonly Clean and invalidate cached pages within a frame @endxmlonly
+ * 
+ * @xmlonly
+ * Write back and discard cached copies of the range, with Zicbom cbo.flush.
+ * Fails with seL4_IllegalOperation if the kernel is not configured for Zicbom.
+ * @endxmlonly
+ * 
+ * @param[in] _service Capability to the page to invoke.
+ * @param[in] start_offset The offset, relative to the start of the page inclusive. 
+ * @param[in] end_offset The offset, relative to the start of the page exclusive. 
+ * @return @xmlonly <errorenumdesc/> @endxmlonly
+ */
+LIBSEL4_INLINE seL4_Error
+seL4_RISCV_Page_CleanInvalidate_Data(seL4_RISCV_Page _service, seL4_Word start_offset, seL4_Word end_offset)
+{
+	seL4_Error result;
+	seL4_MessageInfo_t tag = seL4_MessageInfo_new(RISCVPageCleanInvalidate_Data, 0, 0, 2);
+	seL4_MessageInfo_t output_tag;
+	seL4_Word mr0;
+	seL4_Word mr1;
+	seL4_Word mr2;
+	seL4_Word mr3;
+
+	/* Marshal and initialise parameters. */
+	mr0 = start_offset;
+	mr1 = end_offset;
+	mr2 = 0;
+	mr3 = 0;
+
+	/* Perform the call, passing in-register arguments directly. */
+	output_tag = seL4_CallWithMRs(_service, tag,
+		&mr0, &mr1, &mr2, &mr3);
+	result = (seL4_Error) seL4_MessageInfo_get_label(output_tag);
+
+	/* Unmarshal registers into IPC buffer on error. */
+	if (result != seL4_NoError) {
+		seL4_SetMR(0, mr0);
+		seL4_SetMR(1, mr1);
+		seL4_SetMR(2, mr2);
+		seL4_SetMR(3, mr3);
+	}
+
+	return result;
+}
+
+/**
+ * @xmlonly <manual name="Unify Instruction" label="riscv_page_unify_instruction"/> @endxmlonly
+ * @brief @xmlonly Make data written to a frame visible to instruction fetch @endxmlonly
+ * 
+ * @xmlonly
+ * Execute fence.i on this hart and on every other hart that is running a thread.
+ * @endxmlonly
+ * 
+ * @param[in] _service Capability to the page to invoke.
+ * @param[in] start_offset The offset, relative to the start of the page inclusive. 
+ * @param[in] end_offset The offset, relative to the start of the page exclusive. 
+ * @return @xmlonly <errorenumdesc/> @endxmlonly
+ */
+LIBSEL4_INLINE seL4_Error
+seL4_RISCV_Page_Unify_Instruction(seL4_RISCV_Page _service, seL4_Word start_offset, seL4_Word end_offset)
+{
+	seL4_Error result;
+	seL4_MessageInfo_t tag = seL4_MessageInfo_new(RISCVPageUnify_Instruction, 0, 0, 2);
+	seL4_MessageInfo_t output_tag;
+	seL4_Word mr0;
+	seL4_Word mr1;
+	seL4_Word mr2;
+	seL4_Word mr3;
+
+	/* Marshal and initialise parameters. */
+	mr0 = start_offset;
+	mr1 = end_offset;
+	mr2 = 0;
+	mr3 = 0;
+
+	/* Perform the call, passing in-register arguments directly. */
+	output_tag = seL4_CallWithMRs(_service, tag,
+		&mr0, &mr1, &mr2, &mr3);
+	result = (seL4_Error) seL4_MessageInfo_get_label(output_tag);
+
+	/* Unmarshal registers into IPC buffer on error. */
+	if (result != seL4_NoError) {
+		seL4_SetMR(0, mr0);
+		seL4_SetMR(1, mr1);
+		seL4_SetMR(2, mr2);
+		seL4_SetMR(3, mr3);
+	}
+
+	return result;
+}
+
 /**
  * @xmlonly <manual name="MakePool" label="riscv_asid_control_makepool"/> @endxmlonly
  * @brief @xmlonly Create an ASID Pool. @endxmlonly
@@ -545,6 +850,177 @@ seL4_Untyped_Retype(seL4_Untyped _service, seL4_Word type, seL4_Word size_bits,
 	return result;
 }
 
+#if defined(CONFIG_EP_PRIORITY_QUEUES)
+/**
+ * @xmlonly <manual name="Retype With Flags" label="untyped_retypeflags"/> @endxmlonly
+ * @brief @xmlonly Retype an untyped object, passing creation flags @endxmlonly
+ * 
+ * @xmlonly
+ * As <texttt text="seL4_Untyped_Retype"/>, with a seventh message word of flags. Bit 0 makes
+ * each created endpoint keep its queue of waiting threads in priority order, and may only be
+ * given when <texttt text="type"/> is <texttt text="seL4_EndpointObject"/>. Any other bit is
+ * rejected. The kernel tracks a fixed number of priority ordered endpoints at a time, and a
+ * retype that would exceed it fails with a range error.
+ * @endxmlonly
+ * 
+ * @param[in] _service CPTR to an untyped object.
+ * @param[in] type The seL4 object type that we are retyping to. 
+ * @param[in] size_bits Used to determine the size of variable-sized objects. 
+ * @param[in] root CPTR to the CNode at the root of the destination CSpace. 
+ * @param[in] node_index CPTR to the destination CNode. Resolved relative to the root parameter. 
+ * @param[in] node_depth Number of bits of node_index to translate when addressing the destination CNode. 
+ * @param[in] node_offset Number of slots into the node at which capabilities start being placed. 
+ * @param[in] num_objects Number of capabilities to create. 
+ * @param[in] flags Creation flags for the new objects. 
+ * @return @xmlonly <errorenumdesc/> @endxmlonly
+ */
+LIBSEL4_INLINE seL4_Error
+seL4_Untyped_RetypeFlags(seL4_Untyped _service, seL4_Word type, seL4_Word size_bits, seL4_CNode root, seL4_Word node_index, seL4_Word node_depth, seL4_Word node_offset, seL4_Word num_objects, seL4_Word flags)
+{
+	seL4_Error result;
+	seL4_MessageInfo_t tag = seL4_MessageInfo_new(UntypedRetype, 0, 1, 7);
+	seL4_MessageInfo_t output_tag;
+	seL4_Word mr0;
+	seL4_Word mr1;
+	seL4_Word mr2;
+	seL4_Word mr3;
+
+	/* Setup input capabilities. */
+	seL4_SetCap(0, root);
+
+	/* Marshal and initialise parameters. */
+	mr0 = type;
+	mr1 = size_bits;
+	mr2 = node_index;
+	mr3 = node_depth;
+	seL4_SetMR(4, node_offset);
+	seL4_SetMR(5, num_objects);
+	seL4_SetMR(6, flags);
+
+	/* Perform the call, passing in-register arguments directly. */
+	output_tag = seL4_CallWithMRs(_service, tag,
+		&mr0, &mr1, &mr2, &mr3);
+	result = (seL4_Error) seL4_MessageInfo_get_label(output_tag);
+
+	/* Unmarshal registers into IPC buffer on error. */
+	if (result != seL4_NoError) {
+		seL4_SetMR(0, mr0);
+		seL4_SetMR(1, mr1);
+		seL4_SetMR(2, mr2);
+		seL4_SetMR(3, mr3);
+	}
+
+	return result;
+}
+#endif
+
+/**
+ * @xmlonly <manual name="Describe" label="untyped_describe"/> @endxmlonly
+ * @brief @xmlonly Report how much of an untyped object is still free @endxmlonly
+ * 
+ * @xmlonly
+ * Return the bytes that a retype could still use, the size in bits of the largest naturally
+ * aligned block within them, and flags: bit 0 is set for an untyped and bit 1 for device memory.
+ * An untyped without children is reported as entirely free, as the next retype resets it.
+ * @endxmlonly
+ * 
+ * @param[in] _service CPTR to an untyped object.
+ * @return @xmlonly
+ *              A <texttt text="seL4_Untyped_Describe_t"/> struct that contains a
+ *              <texttt text="seL4_Error error"/> if an error occured.
+ *              @endxmlonly
+ */
+LIBSEL4_INLINE seL4_Untyped_Describe_t
+seL4_Untyped_Describe(seL4_Untyped _service)
+{
+	seL4_Untyped_Describe_t result;
+	seL4_MessageInfo_t tag = seL4_MessageInfo_new(UntypedDescribe, 0, 0, 0);
+	seL4_MessageInfo_t output_tag;
+	seL4_Word mr0;
+	seL4_Word mr1;
+	seL4_Word mr2;
+	seL4_Word mr3;
+
+	/* Marshal and initialise parameters. */
+	mr0 = 0;
+	mr1 = 0;
+	mr2 = 0;
+	mr3 = 0;
+
+	/* Perform the call, passing in-register arguments directly. */
+	output_tag = seL4_CallWithMRs(_service, tag,
+		&mr0, &mr1, &mr2, &mr3);
+	result.error = seL4_MessageInfo_get_label(output_tag);
+
+	/* Unmarshal registers into IPC buffer on error. */
+	if (result.error != seL4_NoError) {
+		seL4_SetMR(0, mr0);
+		seL4_SetMR(1, mr1);
+		seL4_SetMR(2, mr2);
+		seL4_SetMR(3, mr3);
+		return result;
+	}
+
+	/* Unmarshal result. */
+	result.free_bytes = mr0;
+	result.largest_block_bits = mr1;
+	result.flags = mr2;
+	return result;
+}
+
+/**
+ * @xmlonly <manual name="Describe Range" label="untyped_describerange"/> @endxmlonly
+ * @brief @xmlonly Describe the untyped objects in a range of slots @endxmlonly
+ * 
+ * @xmlonly
+ * For each slot, write three message registers in the format of seL4_Untyped_Describe.
+ * Slots that do not hold an untyped are described as zeros. At most seL4_MsgMaxLength / 3
+ * slots can be described, and the range must lie in one CNode. The invoked untyped is not
+ * described unless it is in the range.
+ * @endxmlonly
+ * 
+ * @param[in] _service CPTR to an untyped object.
+ * @param[in] root CPTR to the CNode at the root of the CSpace holding the range. 
+ * @param[in] node_index CPTR to the CNode holding the range. Resolved relative to the root parameter. 
+ * @param[in] node_depth Number of bits of node_index to translate when addressing the CNode. 
+ * @param[in] node_offset Slot in the CNode at which the range starts. 
+ * @param[in] count Number of slots to describe. 
+ * @return @xmlonly <errorenumdesc/> @endxmlonly
+ */
+LIBSEL4_INLINE seL4_Error
+seL4_Untyped_DescribeRange(seL4_Untyped _service, seL4_CNode root, seL4_Word node_index, seL4_Word node_depth, seL4_Word node_offset, seL4_Word count)
+{
+	seL4_Error result;
+	seL4_MessageInfo_t tag = seL4_MessageInfo_new(UntypedDescribeRange, 0, 1, 4);
+	seL4_MessageInfo_t output_tag;
+	seL4_Word mr0;
+	seL4_Word mr1;
+	seL4_Word mr2;
+	seL4_Word mr3;
+
+	/* Setup input capabilities. */
+	seL4_SetCap(0, root);
+
+	/* Marshal and initialise parameters. */
+	mr0 = node_index;
+	mr1 = node_depth;
+	mr2 = node_offset;
+	mr3 = count;
+
+	/* Perform the call, passing in-register arguments directly. */
+	output_tag = seL4_CallWithMRs(_service, tag,
+		&mr0, &mr1, &mr2, &mr3);
+	result = (seL4_Error) seL4_MessageInfo_get_label(output_tag);
+
+	/* Unmarshal registers into IPC buffer, the descriptions start in them. */
+	seL4_SetMR(0, mr0);
+	seL4_SetMR(1, mr1);
+	seL4_SetMR(2, mr2);
+	seL4_SetMR(3, mr3);
+
+	return result;
+}
+
 /**
  * @xmlonly <manual name="Read Registers" label="tcb_readregisters"/> @endxmlonly
  * @brief @xmlonly Read a thread's registers into the first <texttt text="count"/> fields of a given
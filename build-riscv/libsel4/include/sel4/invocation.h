@@ -64,6 +64,8 @@ enum invocation_label {
     IRQSetIRQHandler,
     IRQClearIRQHandler,
     DomainSetSet,
+    UntypedDescribe,
+    UntypedDescribeRange,
     nInvocationLabels
 };
 #include <sel4/sel4_arch/invocation.h>
@@ -31,37 +31,68 @@ typedef enum {
     seL4_SysReply = -6,
     seL4_SysYield = -7,
     seL4_SysNBRecv = -8,
+#if defined CONFIG_MULTICALL
+    seL4_SysMulticall = -9,
+#endif /* defined CONFIG_MULTICALL */
+#if defined CONFIG_IRQ_ACK_WAIT
+    seL4_SysIRQAckWait = -10,
+#endif /* defined CONFIG_IRQ_ACK_WAIT */
+#if defined CONFIG_NTFN_USER_WORD
+    seL4_SysNtfnSetUserWord = -11,
+#endif /* defined CONFIG_NTFN_USER_WORD */
+#if defined CONFIG_WAIT_SET
+    seL4_SysWaitSetJoin = -12,
+    seL4_SysWaitSetRecv = -13,
+#endif /* defined CONFIG_WAIT_SET */
 #if defined CONFIG_PRINTING
-    seL4_SysDebugPutChar = -9,
-    seL4_SysDebugDumpScheduler = -10,
+    seL4_SysDebugPutChar = -14,
+    seL4_SysDebugDumpScheduler = -15,
 #endif /* defined CONFIG_PRINTING */
 #if defined CONFIG_DEBUG_BUILD
-    seL4_SysDebugHalt = -11,
-    seL4_SysDebugCapIdentify = -12,
-    seL4_SysDebugSnapshot = -13,
-    seL4_SysDebugNameThread = -14,
+    seL4_SysDebugHalt = -16,
+    seL4_SysDebugCapIdentify = -17,
+    seL4_SysDebugSnapshot = -18,
+    seL4_SysDebugNameThread = -19,
 #endif /* defined CONFIG_DEBUG_BUILD */
 #if defined CONFIG_DANGEROUS_CODE_INJECTION
-    seL4_SysDebugRun = -15,
+    seL4_SysDebugRun = -20,
 #endif /* defined CONFIG_DANGEROUS_CODE_INJECTION */
 #if defined CONFIG_ENABLE_BENCHMARKS
-    seL4_SysBenchmarkFlushCaches = -16,
-    seL4_SysBenchmarkResetLog = -17,
-    seL4_SysBenchmarkFinalizeLog = -18,
-    seL4_SysBenchmarkSetLogBuffer = -19,
-    seL4_SysBenchmarkNullSyscall = -20,
+    seL4_SysBenchmarkFlushCaches = -21,
+    seL4_SysBenchmarkResetLog = -22,
+    seL4_SysBenchmarkFinalizeLog = -23,
+    seL4_SysBenchmarkSetLogBuffer = -24,
+    seL4_SysBenchmarkNullSyscall = -25,
 #endif /* defined CONFIG_ENABLE_BENCHMARKS */
 #if defined CONFIG_BENCHMARK_TRACK_UTILISATION
-    seL4_SysBenchmarkGetThreadUtilisation = -21,
-    seL4_SysBenchmarkResetThreadUtilisation = -22,
+    seL4_SysBenchmarkGetThreadUtilisation = -26,
+    seL4_SysBenchmarkResetThreadUtilisation = -27,
 #endif /* defined CONFIG_BENCHMARK_TRACK_UTILISATION */
 #if defined CONFIG_KERNEL_X86_DANGEROUS_MSR
-    seL4_SysX86DangerousWRMSR = -23,
-    seL4_SysX86DangerousRDMSR = -24,
+    seL4_SysX86DangerousWRMSR = -28,
+    seL4_SysX86DangerousRDMSR = -29,
 #endif /* defined CONFIG_KERNEL_X86_DANGEROUS_MSR */
 #if defined CONFIG_VTX
-    seL4_SysVMEnter = -25,
+    seL4_SysVMEnter = -30,
 #endif /* defined CONFIG_VTX */
+#if defined CONFIG_KERNEL_PRINT_BUFFER
+    seL4_SysDebugSetPrintBuffer = -31,
+#endif /* defined CONFIG_KERNEL_PRINT_BUFFER */
+#if defined CONFIG_IRQ_STATISTICS
+    seL4_SysDebugGetIRQStatistics = -32,
+    seL4_SysDebugResetIRQStatistics = -33,
+#endif /* defined CONFIG_IRQ_STATISTICS */
+#if defined CONFIG_PROFILER_SAMPLING
+    seL4_SysDebugSetProfilerNotification = -34,
+    seL4_SysDebugGetProfilerSamples = -35,
+#endif /* defined CONFIG_PROFILER_SAMPLING */
+#if defined CONFIG_BENCHMARK_LATENCY_HISTOGRAMS
+    seL4_SysBenchmarkGetLatencyHistogram = -36,
+    seL4_SysBenchmarkResetLatencyHistograms = -37,
+#endif /* defined CONFIG_BENCHMARK_LATENCY_HISTOGRAMS */
+#if defined CONFIG_CAP_LOOKUP_CACHE
+    seL4_SysBenchmarkGetCapLookupCacheStats = -38,
+#endif /* defined CONFIG_CAP_LOOKUP_CACHE */
     SEL4_FORCE_LONG_ENUM(seL4_Syscall_ID)
 } seL4_Syscall_ID;
 
@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+#
+# This software may be distributed and modified according to the terms of
+# the BSD 2-Clause license. Note that NO WARRANTY is provided.
+# See "LICENSE_BSD2.txt" for details.
+#
+
+"""
+Offline analysis of a kernel tracepoint log.
+
+The kernel appends one (id, duration) pair of machine words to the log
+buffer every time a TRACE_POINT_STOP is reached. Copy the buffer out of the
+target either as a raw binary dump (little endian, 64-bit words) or as text
+with one "id duration" pair per line (decimal or 0x-prefixed hex; anything
+else on the line is ignored), then:
+
+    tracepoints.py log.bin                  # per tracepoint summary
+    tracepoints.py --histogram log.txt      # log2 histograms as well
+    tracepoints.py --folded log.bin > out   # input for flamegraph.pl
+
+Durations are in cycles, as read by the kernel's timestamp().
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+# Must match enum tracepoint_id in benchmark/kernel_tracepoints.h
+KERNEL_TRACEPOINTS = {
+    0: "decodeInvocation",
+    1: "schedule",
+    2: "setVMRoot",
+    3: "resetUntypedCap",
+    4: "cteRevoke",
+}
+
+# Tracepoints that the kernel can only reach from within another one. As a
+# tracepoint is logged when it stops, children appear in the log before the
+# parent that encloses them.
+KERNEL_PARENTS = {
+    2: 1,
+    3: 0,
+    4: 0,
+}
+
+PAIR_RE = re.compile(r"^\s*(0x[0-9a-fA-F]+|\d+)[\s,:]+(0x[0-9a-fA-F]+|\d+)\b", re.M)
+
+
+def read_log(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    try:
+        text = data.decode("ascii")
+    except UnicodeDecodeError:
+        text = None
+
+    entries = []
+    if text is not None and PAIR_RE.search(text) is not None:
+        for line in text.splitlines():
+            m = PAIR_RE.match(line)
+            if m:
+                entries.append((int(m.group(1), 0), int(m.group(2), 0)))
+        return entries
+
+    if len(data) % 16:
+        sys.exit("%s: binary log is not a whole number of entries" % path)
+    for ident, duration in struct.iter_unpack("<QQ", data):
+        # An unused tail of the log buffer is zero filled
+        if ident == 0 and duration == 0:
+            break
+        entries.append((ident, duration))
+    return entries
+
+
+def parse_names(args):
+    names = dict(KERNEL_TRACEPOINTS)
+    for spec in args:
+        ident, _, name = spec.partition("=")
+        names[int(ident, 0)] = name
+    return names
+
+
+def name_of(names, ident):
+    return names.get(ident, "tracepoint_%d" % ident)
+
+
+def percentile(ordered, pct):
+    index = min(len(ordered) - 1, (len(ordered) * pct) // 100)
+    return ordered[index]
+
+
+def summarise(entries, names, histogram):
+    samples = {}
+    for ident, duration in entries:
+        samples.setdefault(ident, []).append(duration)
+
+    print("%-20s %8s %10s %10s %10s %10s %10s" %
+          ("tracepoint", "count", "min", "median", "p99", "max", "mean"))
+    for ident in sorted(samples):
+        ordered = sorted(samples[ident])
+        print("%-20s %8d %10d %10d %10d %10d %10d" %
+              (name_of(names, ident), len(ordered), ordered[0],
+               percentile(ordered, 50), percentile(ordered, 99), ordered[-1],
+               sum(ordered) // len(ordered)))
+
+    if not histogram:
+        return
+    for ident in sorted(samples):
+        buckets = {}
+        for duration in samples[ident]:
+            bucket = duration.bit_length()
+            buckets[bucket] = buckets.get(bucket, 0) + 1
+        widest = max(buckets.values())
+        print("\n%s" % name_of(names, ident))
+        for bucket in range(min(buckets), max(buckets) + 1):
+            count = buckets.get(bucket, 0)
+            low = 0 if bucket == 0 else 1 << (bucket - 1)
+            print("  %10d .. %-10d %8d %s" % (low, (1 << bucket) - 1, count,
+                                             "#" * (40 * count // widest)))
+
+
+def folded(entries, names, parents):
+    # Self time of a parent is what is left after its children that were
+    # logged since the previous instance of the same parent.
+    totals = {}
+    pending = {}
+    for ident, duration in entries:
+        children = pending.pop(ident, [])
+        self_time = duration - sum(d for _, d in children)
+        stack = [name_of(names, ident)]
+        parent = parents.get(ident)
+        while parent is not None:
+            stack.insert(0, name_of(names, parent))
+            parent = parents.get(parent)
+        key = ";".join(["kernel"] + stack)
+        totals[key] = totals.get(key, 0) + max(self_time, 0)
+        if ident in parents:
+            pending.setdefault(parents[ident], []).append((ident, duration))
+
+    for key in sorted(totals):
+        print("%s %d" % (key, totals[key]))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Summarise a kernel tracepoint log.")
+    parser.add_argument("log", help="binary or text dump of the log buffer")
+    parser.add_argument("--name", action="append", default=[],
+                        metavar="ID=NAME",
+                        help="name a tracepoint that the kernel does not define")
+    parser.add_argument("--histogram", action="store_true",
+                        help="print a log2 histogram for every tracepoint")
+    parser.add_argument("--folded", action="store_true",
+                        help="print folded stacks instead of a summary")
+    args = parser.parse_args()
+
+    entries = read_log(args.log)
+    if not entries:
+        sys.exit("%s: no tracepoint entries" % args.log)
+    names = parse_names(args.name)
+
+    if args.folded:
+        folded(entries, names, KERNEL_PARENTS)
+    else:
+        summarise(entries, names, args.histogram)
+
+
+if __name__ == "__main__":
+    main()